@@ -0,0 +1,1386 @@
+/*
+** Created by doom on 18/10/26.
+*/
+
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fcntl.h>
+#include <unistd.h>
+#include <memory>
+#include <vector>
+#include <list>
+#include <numeric>
+#include <random>
+#include <string>
+#include <string_view>
+#include <cstring>
+#include <algorithm>
+#include <utility>
+#include <smite/smite.hpp>
+
+namespace
+{
+    using value_type = std::int32_t;
+
+    class raw_array
+    {
+    public:
+        using iterator = value_type *;
+
+        explicit raw_array(std::size_t size) : _data(new value_type[size]), _size(size)
+        {
+        }
+
+        iterator begin() const noexcept
+        {
+            return _data.get();
+        }
+
+        iterator end() const noexcept
+        {
+            return _data.get() + _size;
+        }
+
+    private:
+        std::unique_ptr<value_type[]> _data;
+        std::size_t _size;
+    };
+
+    template <typename Container>
+    Container make_source(std::size_t size)
+    {
+        Container c(size);
+
+        std::iota(std::begin(c), std::end(c), 0);
+        return c;
+    }
+
+    void set_counters(benchmark::State &state, std::size_t streams = 1)
+    {
+        auto elements = static_cast<int64_t>(state.iterations()) * state.range(0);
+
+        state.SetItemsProcessed(elements);
+        state.SetBytesProcessed(elements * static_cast<int64_t>(streams * sizeof(value_type)));
+        state.counters["time/elem"] = benchmark::Counter(static_cast<double>(elements),
+                                                         benchmark::Counter::kIsRate |
+                                                         benchmark::Counter::kInvert);
+    }
+
+    void sizes(benchmark::internal::Benchmark *b)
+    {
+        b->RangeMultiplier(16)->Range(1 << 8, 1 << 20);
+    }
+
+    constexpr auto twice = [](value_type i) {
+        return i * 2;
+    };
+
+    constexpr auto is_even = [](value_type i) {
+        return i % 2 == 0;
+    };
+}
+
+/*
+** transform
+*/
+
+template <typename Container>
+static void transform_hand(benchmark::State &state)
+{
+    auto c = make_source<Container>(state.range(0));
+
+    for (auto _ : state) {
+        int64_t sum = 0;
+        for (auto it = std::begin(c); it != std::end(c); ++it) {
+            sum += twice(*it);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    set_counters(state);
+}
+
+template <typename Container>
+static void transform_smite(benchmark::State &state)
+{
+    auto c = make_source<Container>(state.range(0));
+
+    for (auto _ : state) {
+        int64_t sum = 0;
+        for (auto v : smite::transform(c, twice)) {
+            sum += v;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    set_counters(state);
+}
+
+/*
+** filter
+*/
+
+template <typename Container>
+static void filter_hand(benchmark::State &state)
+{
+    auto c = make_source<Container>(state.range(0));
+
+    for (auto _ : state) {
+        int64_t sum = 0;
+        for (auto it = std::begin(c); it != std::end(c); ++it) {
+            if (is_even(*it)) {
+                sum += *it;
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    set_counters(state);
+}
+
+template <typename Container>
+static void filter_smite(benchmark::State &state)
+{
+    auto c = make_source<Container>(state.range(0));
+
+    for (auto _ : state) {
+        int64_t sum = 0;
+        for (auto v : smite::filter(c, is_even)) {
+            sum += v;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    set_counters(state);
+}
+
+/*
+** enumerate
+*/
+
+template <typename Container>
+static void enumerate_hand(benchmark::State &state)
+{
+    auto c = make_source<Container>(state.range(0));
+
+    for (auto _ : state) {
+        int64_t sum = 0;
+        std::ptrdiff_t idx = 0;
+        for (auto it = std::begin(c); it != std::end(c); ++it, ++idx) {
+            sum += idx ^ *it;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    set_counters(state);
+}
+
+template <typename Container>
+static void enumerate_smite(benchmark::State &state)
+{
+    auto c = make_source<Container>(state.range(0));
+
+    for (auto _ : state) {
+        int64_t sum = 0;
+        for (auto[idx, v] : smite::enumerate(c)) {
+            sum += idx ^ v;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    set_counters(state);
+}
+
+/*
+** zip
+*/
+
+template <typename Container>
+static void zip_hand(benchmark::State &state)
+{
+    auto c1 = make_source<Container>(state.range(0));
+    auto c2 = make_source<Container>(state.range(0));
+
+    for (auto _ : state) {
+        int64_t sum = 0;
+        auto it2 = std::begin(c2);
+        for (auto it = std::begin(c1); it != std::end(c1); ++it, ++it2) {
+            sum += *it * *it2;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    set_counters(state, 2);
+}
+
+template <typename Container>
+static void zip_smite(benchmark::State &state)
+{
+    auto c1 = make_source<Container>(state.range(0));
+    auto c2 = make_source<Container>(state.range(0));
+
+    for (auto _ : state) {
+        int64_t sum = 0;
+        for (auto[a, b] : smite::zip(c1, c2)) {
+            sum += a * b;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    set_counters(state, 2);
+}
+
+/*
+** step
+*/
+
+template <typename Container>
+static void step_hand(benchmark::State &state)
+{
+    auto c = make_source<Container>(state.range(0));
+
+    for (auto _ : state) {
+        int64_t sum = 0;
+        for (auto it = std::begin(c); it != std::end(c);) {
+            sum += *it;
+            ++it;
+            if (it != std::end(c)) {
+                ++it;
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    set_counters(state);
+}
+
+template <typename Container>
+static void step_smite(benchmark::State &state)
+{
+    auto c = make_source<Container>(state.range(0));
+
+    for (auto _ : state) {
+        int64_t sum = 0;
+        for (auto v : smite::step(c, 2)) {
+            sum += v;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    set_counters(state);
+}
+
+/*
+** enumerate | filter | transform
+*/
+
+template <typename Container>
+static void chain_hand(benchmark::State &state)
+{
+    auto c = make_source<Container>(state.range(0));
+
+    for (auto _ : state) {
+        int64_t sum = 0;
+        std::ptrdiff_t idx = 0;
+        for (auto it = std::begin(c); it != std::end(c); ++it, ++idx) {
+            if (is_even(*it)) {
+                sum += idx;
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    set_counters(state);
+}
+
+template <typename Container>
+static void chain_smite(benchmark::State &state)
+{
+    using namespace smite;
+    auto c = make_source<Container>(state.range(0));
+    auto keep_if_even = make_filter([](auto &&pair) { return is_even(pair.second); });
+    auto take_index = make_transform([](auto &&pair) { return pair.first; });
+
+    for (auto _ : state) {
+        int64_t sum = 0;
+        for (auto idx : c | enumerate | keep_if_even | take_index) {
+            sum += idx;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    set_counters(state);
+}
+
+/*
+** transform | transform | filter
+*/
+
+template <typename Container>
+static void transform_chain_hand(benchmark::State &state)
+{
+    auto c = make_source<Container>(state.range(0));
+
+    for (auto _ : state) {
+        int64_t sum = 0;
+        for (auto it = std::begin(c); it != std::end(c); ++it) {
+            auto v = twice(twice(*it) + 1);
+            if (v % 3 == 0) {
+                sum += v;
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    set_counters(state);
+}
+
+template <typename Container>
+static void transform_chain_smite(benchmark::State &state)
+{
+    using namespace smite;
+    auto c = make_source<Container>(state.range(0));
+    auto pipeline = make_transform([](value_type i) { return twice(i) + 1; })
+                    | make_transform(twice)
+                    | make_filter([](value_type i) { return i % 3 == 0; });
+
+    for (auto _ : state) {
+        int64_t sum = 0;
+        for (auto v : c | pipeline) {
+            sum += v;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    set_counters(state);
+}
+
+/*
+** filter selectivity
+*/
+
+namespace
+{
+    std::vector<value_type> make_percentages(std::size_t size)
+    {
+        std::vector<value_type> v(size);
+        std::mt19937 gen(42);
+        std::uniform_int_distribution<value_type> dist(0, 99);
+
+        std::generate(v.begin(), v.end(), [&] { return dist(gen); });
+        return v;
+    }
+
+    void selectivities(benchmark::internal::Benchmark *b)
+    {
+        for (auto selectivity : {1, 10, 25, 50, 75, 90, 99}) {
+            b->Args({1 << 16, selectivity});
+        }
+    }
+}
+
+static void filter_selectivity_hand(benchmark::State &state)
+{
+    auto v = make_percentages(state.range(0));
+    std::vector<value_type> out(v.size());
+    auto threshold = static_cast<value_type>(state.range(1));
+
+    for (auto _ : state) {
+        auto dest = out.begin();
+        for (auto i : v) {
+            if (i < threshold) {
+                *dest++ = i;
+            }
+        }
+        benchmark::DoNotOptimize(dest);
+        benchmark::ClobberMemory();
+    }
+    set_counters(state);
+}
+
+static void filter_selectivity_scalar(benchmark::State &state)
+{
+    auto v = make_percentages(state.range(0));
+    std::vector<value_type> out(v.size());
+    auto threshold = static_cast<value_type>(state.range(1));
+    auto identity = smite::transform(v, [](value_type i) { return i; });
+
+    for (auto _ : state) {
+        auto dest = out.begin();
+        for (auto i : smite::filter(identity, [threshold](value_type i) { return i < threshold; })) {
+            *dest++ = i;
+        }
+        benchmark::DoNotOptimize(dest);
+        benchmark::ClobberMemory();
+    }
+    set_counters(state);
+}
+
+static void filter_selectivity_smite(benchmark::State &state)
+{
+    auto v = make_percentages(state.range(0));
+    std::vector<value_type> out(v.size());
+    auto threshold = static_cast<value_type>(state.range(1));
+
+    for (auto _ : state) {
+        auto dest = out.begin();
+        for (auto i : smite::filter(v, [threshold](value_type i) { return i < threshold; })) {
+            *dest++ = i;
+        }
+        benchmark::DoNotOptimize(dest);
+        benchmark::ClobberMemory();
+    }
+    set_counters(state);
+}
+
+static void filter_selectivity_push(benchmark::State &state)
+{
+    auto v = make_percentages(state.range(0));
+    std::vector<value_type> out(v.size());
+    auto threshold = static_cast<value_type>(state.range(1));
+
+    for (auto _ : state) {
+        auto dest = out.begin();
+        smite::for_each(smite::filter(v, [threshold](value_type i) { return i < threshold; }), [&dest](value_type i) {
+            *dest++ = i;
+        });
+        benchmark::DoNotOptimize(dest);
+        benchmark::ClobberMemory();
+    }
+    set_counters(state);
+}
+
+BENCHMARK(filter_selectivity_hand)->Apply(selectivities);
+BENCHMARK(filter_selectivity_scalar)->Apply(selectivities);
+BENCHMARK(filter_selectivity_smite)->Apply(selectivities);
+BENCHMARK(filter_selectivity_push)->Apply(selectivities);
+
+/*
+** filter over an expensive transform
+*/
+
+static void filter_decode_hand(benchmark::State &state)
+{
+    auto v = make_source<std::vector<value_type>>(state.range(0));
+
+    for (auto _ : state) {
+        std::size_t total = 0;
+        for (auto i : v) {
+            auto s = std::to_string(i);
+            if (s.back() != '7') {
+                total += s.size();
+            }
+        }
+        benchmark::DoNotOptimize(total);
+    }
+    set_counters(state);
+}
+
+static void filter_decode_smite(benchmark::State &state)
+{
+    auto v = make_source<std::vector<value_type>>(state.range(0));
+    auto decoded = smite::transform(v, [](value_type i) { return std::to_string(i); });
+
+    for (auto _ : state) {
+        std::size_t total = 0;
+        for (const auto &s : smite::filter(decoded, [](const std::string &s) { return s.back() != '7'; })) {
+            total += s.size();
+        }
+        benchmark::DoNotOptimize(total);
+    }
+    set_counters(state);
+}
+
+BENCHMARK(filter_decode_hand)->Apply(sizes);
+BENCHMARK(filter_decode_smite)->Apply(sizes);
+
+/*
+** reductions over float columns
+*/
+
+namespace
+{
+    std::vector<float> make_floats(std::size_t size)
+    {
+        std::vector<float> v(size);
+        std::mt19937 gen(42);
+        std::uniform_real_distribution<float> dist(-1.f, 1.f);
+
+        std::generate(v.begin(), v.end(), [&] { return dist(gen); });
+        return v;
+    }
+}
+
+static void sum_squares_hand(benchmark::State &state)
+{
+    auto v = make_floats(state.range(0));
+
+    for (auto _ : state) {
+        float total = 0;
+        for (auto f : v) {
+            total += f * f;
+        }
+        benchmark::DoNotOptimize(total);
+    }
+    set_counters(state);
+}
+
+static void sum_squares_smite(benchmark::State &state)
+{
+    auto v = make_floats(state.range(0));
+    auto squares = smite::transform(v, [](float f) { return f * f; });
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(smite::sum(squares));
+    }
+    set_counters(state);
+}
+
+static void dot_hand(benchmark::State &state)
+{
+    auto a = make_floats(state.range(0));
+    auto b = make_floats(state.range(0));
+
+    for (auto _ : state) {
+        float total = 0;
+        for (auto [x, y] : smite::zip(a, b)) {
+            total += x * y;
+        }
+        benchmark::DoNotOptimize(total);
+    }
+    set_counters(state, 2);
+}
+
+static void dot_smite(benchmark::State &state)
+{
+    auto a = make_floats(state.range(0));
+    auto b = make_floats(state.range(0));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(smite::dot(a, b));
+    }
+    set_counters(state, 2);
+}
+
+static void min_max_hand(benchmark::State &state)
+{
+    auto v = make_floats(state.range(0));
+
+    for (auto _ : state) {
+        auto [lo, hi] = std::minmax_element(v.begin(), v.end());
+        benchmark::DoNotOptimize(*lo + *hi);
+    }
+    set_counters(state);
+}
+
+static void min_max_smite(benchmark::State &state)
+{
+    auto v = make_floats(state.range(0));
+
+    for (auto _ : state) {
+        auto bounds = smite::min_max(v);
+        benchmark::DoNotOptimize(bounds->first + bounds->second);
+    }
+    set_counters(state);
+}
+
+BENCHMARK(sum_squares_hand)->Apply(sizes);
+BENCHMARK(sum_squares_smite)->Apply(sizes);
+BENCHMARK(dot_hand)->Apply(sizes);
+BENCHMARK(dot_smite)->Apply(sizes);
+BENCHMARK(min_max_hand)->Apply(sizes);
+BENCHMARK(min_max_smite)->Apply(sizes);
+
+/*
+** materializing pipelines into vectors
+*/
+
+static void collect_transform_hand(benchmark::State &state)
+{
+    auto v = make_source<std::vector<value_type>>(state.range(0));
+
+    for (auto _ : state) {
+        std::vector<value_type> out;
+        for (auto i : smite::transform(v, twice)) {
+            out.push_back(i);
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+    set_counters(state);
+}
+
+static void collect_transform_smite(benchmark::State &state)
+{
+    auto v = make_source<std::vector<value_type>>(state.range(0));
+
+    for (auto _ : state) {
+        auto out = smite::transform(v, twice) | smite::to<std::vector<value_type>>();
+        benchmark::DoNotOptimize(out.data());
+    }
+    set_counters(state);
+}
+
+static void collect_filter_hand(benchmark::State &state)
+{
+    auto v = make_source<std::vector<value_type>>(state.range(0));
+
+    for (auto _ : state) {
+        std::vector<value_type> out;
+        for (auto i : smite::filter(v, is_even)) {
+            out.push_back(i);
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+    set_counters(state);
+}
+
+static void collect_filter_smite(benchmark::State &state)
+{
+    auto v = make_source<std::vector<value_type>>(state.range(0));
+
+    for (auto _ : state) {
+        auto out = smite::filter(v, is_even) | smite::to<std::vector<value_type>>();
+        benchmark::DoNotOptimize(out.data());
+    }
+    set_counters(state);
+}
+
+BENCHMARK(collect_transform_hand)->Apply(sizes);
+BENCHMARK(collect_transform_smite)->Apply(sizes);
+BENCHMARK(collect_filter_hand)->Apply(sizes);
+BENCHMARK(collect_filter_smite)->Apply(sizes);
+
+/*
+** deep chains, pulled by a range-for loop or pushed by for_each
+*/
+
+namespace
+{
+    template <typename Container>
+    auto make_deep_chain(const Container &c)
+    {
+        return smite::filter(smite::transform(smite::step(c, 2), twice), [](value_type i) { return i % 3 != 0; });
+    }
+}
+
+template <typename Container>
+static void deep_chain_pull(benchmark::State &state)
+{
+    auto c = make_source<Container>(state.range(0));
+
+    for (auto _ : state) {
+        value_type total = 0;
+        for (auto i : make_deep_chain(c)) {
+            total += i;
+        }
+        benchmark::DoNotOptimize(total);
+    }
+    set_counters(state);
+}
+
+template <typename Container>
+static void deep_chain_push(benchmark::State &state)
+{
+    auto c = make_source<Container>(state.range(0));
+
+    for (auto _ : state) {
+        value_type total = 0;
+        smite::for_each(make_deep_chain(c), [&total](value_type i) { total += i; });
+        benchmark::DoNotOptimize(total);
+    }
+    set_counters(state);
+}
+
+BENCHMARK_TEMPLATE(deep_chain_pull, std::vector<value_type>)->Apply(sizes);
+BENCHMARK_TEMPLATE(deep_chain_push, std::vector<value_type>)->Apply(sizes);
+BENCHMARK_TEMPLATE(deep_chain_pull, std::list<value_type>)->Apply(sizes);
+BENCHMARK_TEMPLATE(deep_chain_push, std::list<value_type>)->Apply(sizes);
+
+/*
+** flattening lists of pages
+*/
+
+namespace
+{
+    std::vector<std::vector<value_type>> make_pages(std::size_t size)
+    {
+        constexpr std::size_t page_size = 1024;
+        std::vector<std::vector<value_type>> pages;
+
+        for (std::size_t i = 0; i < size; i += page_size) {
+            pages.push_back(make_source<std::vector<value_type>>(std::min(page_size, size - i)));
+        }
+        return pages;
+    }
+}
+
+static void join_hand(benchmark::State &state)
+{
+    auto pages = make_pages(state.range(0));
+
+    for (auto _ : state) {
+        std::int64_t total = 0;
+
+        for (const auto &page : pages) {
+            for (auto i : page) {
+                if (is_even(i)) {
+                    total += twice(i);
+                }
+            }
+        }
+        benchmark::DoNotOptimize(total);
+    }
+    set_counters(state);
+}
+
+static void join_pull(benchmark::State &state)
+{
+    auto pages = make_pages(state.range(0));
+
+    for (auto _ : state) {
+        std::int64_t total = 0;
+
+        for (auto i : smite::join(pages) | smite::make_filter(is_even) | smite::make_transform(twice)) {
+            total += i;
+        }
+        benchmark::DoNotOptimize(total);
+    }
+    set_counters(state);
+}
+
+static void join_push(benchmark::State &state)
+{
+    auto pages = make_pages(state.range(0));
+
+    for (auto _ : state) {
+        auto flat = smite::join(pages) | smite::make_filter(is_even) | smite::make_transform(twice);
+
+        benchmark::DoNotOptimize(smite::sum(flat, std::int64_t{0}));
+    }
+    set_counters(state);
+}
+
+BENCHMARK(join_hand)->Apply(sizes);
+BENCHMARK(join_pull)->Apply(sizes);
+BENCHMARK(join_push)->Apply(sizes);
+
+/*
+** gathering rows of a table larger than the caches
+*/
+
+namespace
+{
+    const std::vector<value_type> &gather_table()
+    {
+        static const auto table = make_source<std::vector<value_type>>(1u << 27);
+
+        return table;
+    }
+
+    std::vector<std::uint32_t> make_indices(std::size_t size)
+    {
+        std::mt19937 gen(42);
+        std::uniform_int_distribution<std::uint32_t> dist(0, (1u << 27) - 1);
+        std::vector<std::uint32_t> indices(size);
+
+        std::generate(indices.begin(), indices.end(), [&] { return dist(gen); });
+        return indices;
+    }
+}
+
+static void gather_hand(benchmark::State &state)
+{
+    const auto &table = gather_table();
+    auto indices = make_indices(state.range(0));
+
+    for (auto _ : state) {
+        std::int64_t total = 0;
+
+        for (auto i : indices) {
+            total += table[i];
+        }
+        benchmark::DoNotOptimize(total);
+    }
+    set_counters(state);
+}
+
+static void gather_smite(benchmark::State &state)
+{
+    const auto &table = gather_table();
+    auto indices = make_indices(state.range(0));
+
+    for (auto _ : state) {
+        auto rows = smite::transform(indices, [&table](std::uint32_t i) { return table[i]; });
+
+        benchmark::DoNotOptimize(smite::sum(rows, std::int64_t{0}));
+    }
+    set_counters(state);
+}
+
+template <std::size_t Distance>
+static void gather_prefetch(benchmark::State &state)
+{
+    const auto &table = gather_table();
+    auto indices = make_indices(state.range(0));
+    auto row = [&table](std::uint32_t i) { return &table[i]; };
+
+    for (auto _ : state) {
+        auto ahead = [&] {
+            if constexpr (Distance == 0) {
+                return smite::prefetch(indices, row, 16);
+            } else {
+                return smite::prefetch<Distance>(indices, row);
+            }
+        }();
+        auto rows = smite::transform(ahead, [&table](std::uint32_t i) { return table[i]; });
+
+        benchmark::DoNotOptimize(smite::sum(rows, std::int64_t{0}));
+    }
+    set_counters(state);
+}
+
+BENCHMARK(gather_hand)->Apply(sizes);
+BENCHMARK(gather_smite)->Apply(sizes);
+BENCHMARK_TEMPLATE(gather_prefetch, 0)->Apply(sizes);
+BENCHMARK_TEMPLATE(gather_prefetch, 16)->Apply(sizes);
+
+/*
+** walking many independent linked lists
+*/
+
+namespace
+{
+    /*
+    ** Nodes are pushed onto random chains, so that the consecutive nodes of a chain lie far apart
+    ** in memory, and the whole set is larger than the caches.
+    */
+    const std::vector<std::list<value_type>> &chase_chains()
+    {
+        static const auto chains = [] {
+            std::vector<std::list<value_type>> c(1u << 13);
+            std::mt19937 gen(42);
+            std::uniform_int_distribution<std::size_t> dist(0, c.size() - 1);
+
+            for (value_type i = 0; i < (1 << 23); ++i) {
+                c[dist(gen)].push_back(i);
+            }
+            return c;
+        }();
+
+        return chains;
+    }
+}
+
+static void chase_hand(benchmark::State &state)
+{
+    const auto &chains = chase_chains();
+    std::vector<std::int64_t> sums(chains.size());
+
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < chains.size(); ++i) {
+            std::int64_t total = 0;
+
+            for (auto v : chains[i]) {
+                total += v;
+            }
+            sums[i] = total;
+        }
+        benchmark::DoNotOptimize(sums.data());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * (1 << 23));
+}
+
+template <std::size_t Width>
+static void chase_smite(benchmark::State &state)
+{
+    const auto &chains = chase_chains();
+    std::vector<std::int64_t> sums(chains.size());
+
+    for (auto _ : state) {
+        std::fill(sums.begin(), sums.end(), 0);
+        for (auto [chain, v] : smite::interleave_chase<Width>(chains)) {
+            sums[chain] += v;
+        }
+        benchmark::DoNotOptimize(sums.data());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * (1 << 23));
+}
+
+BENCHMARK(chase_hand)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(chase_smite, 1)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(chase_smite, 8)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(chase_smite, 16)->Unit(benchmark::kMillisecond);
+
+/*
+** deinterleaving stereo samples
+*/
+
+static void deinterleave_hand(benchmark::State &state)
+{
+    auto stereo = make_source<std::vector<value_type>>(state.range(0) * 2);
+    std::vector<value_type> left(state.range(0));
+    std::vector<value_type> right(state.range(0));
+
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < left.size(); ++i) {
+            left[i] = stereo[2 * i];
+            right[i] = stereo[2 * i + 1];
+        }
+        benchmark::DoNotOptimize(left.data());
+        benchmark::DoNotOptimize(right.data());
+    }
+    set_counters(state, 2);
+}
+
+template <std::size_t Stride>
+static void deinterleave_smite(benchmark::State &state)
+{
+    auto stereo = make_source<std::vector<value_type>>(state.range(0) * 2);
+    std::vector<value_type> left(state.range(0));
+    std::vector<value_type> right(state.range(0));
+    auto odd = smite::make_range(stereo.begin() + 1, stereo.end());
+
+    for (auto _ : state) {
+        auto channels = [&] {
+            if constexpr (Stride == 0) {
+                return smite::zip(smite::step(stereo, 2), smite::step(odd, 2));
+            } else {
+                return smite::zip(smite::step<Stride>(stereo), smite::step<Stride>(odd));
+            }
+        }();
+        for (auto &&[l, r, sample] : smite::zip(left, right, channels)) {
+            l = std::get<0>(sample);
+            r = std::get<1>(sample);
+        }
+        benchmark::DoNotOptimize(left.data());
+        benchmark::DoNotOptimize(right.data());
+    }
+    set_counters(state, 2);
+}
+
+BENCHMARK(deinterleave_hand)->Apply(sizes);
+BENCHMARK_TEMPLATE(deinterleave_smite, 0)->Apply(sizes);
+BENCHMARK_TEMPLATE(deinterleave_smite, 2)->Apply(sizes);
+
+/*
+** per-block work over fixed-size blocks
+*/
+
+static constexpr std::size_t block_size = 64;
+
+static void chunk_hand(benchmark::State &state)
+{
+    auto v = make_floats(state.range(0));
+
+    for (auto _ : state) {
+        float peak = 0;
+        for (std::size_t i = 0; i < v.size(); i += block_size) {
+            auto n = std::min(block_size, v.size() - i);
+            float total = 0;
+            for (std::size_t j = 0; j < n; ++j) {
+                total += v[i + j];
+            }
+            peak = std::max(peak, total);
+        }
+        benchmark::DoNotOptimize(peak);
+    }
+    set_counters(state);
+}
+
+static void chunk_smite(benchmark::State &state)
+{
+    auto v = make_floats(state.range(0));
+
+    for (auto _ : state) {
+        float peak = 0;
+        for (auto block : smite::chunk(v, block_size)) {
+            peak = std::max(peak, smite::sum(block));
+        }
+        benchmark::DoNotOptimize(peak);
+    }
+    set_counters(state);
+}
+
+BENCHMARK(chunk_hand)->Apply(sizes);
+BENCHMARK(chunk_smite)->Apply(sizes);
+
+/*
+** moving sum and minimum over a series
+*/
+
+namespace
+{
+    constexpr std::size_t moving_window = 256;
+
+    std::vector<value_type> make_series(std::size_t size)
+    {
+        std::vector<value_type> v(size);
+        std::mt19937 gen(42);
+        std::uniform_int_distribution<value_type> dist(-1000, 1000);
+
+        for (auto &x : v) {
+            x = dist(gen);
+        }
+        return v;
+    }
+}
+
+static void moving_stats_naive(benchmark::State &state)
+{
+    auto v = make_series(state.range(0));
+
+    for (auto _ : state) {
+        long long checksum = 0;
+        for (std::size_t i = 0; i + moving_window <= v.size(); ++i) {
+            long long total = 0;
+            value_type low = v[i];
+            for (std::size_t j = i; j < i + moving_window; ++j) {
+                total += v[j];
+                low = std::min(low, v[j]);
+            }
+            checksum += total + low;
+        }
+        benchmark::DoNotOptimize(checksum);
+    }
+    set_counters(state);
+}
+
+static void moving_stats_smite(benchmark::State &state)
+{
+    auto v = make_series(state.range(0));
+
+    for (auto _ : state) {
+        long long checksum = 0;
+        for (auto [total, low] : smite::zip(smite::rolling(v, moving_window, smite::rolling_sum{}),
+                                            smite::rolling(v, moving_window, smite::rolling_min{}))) {
+            checksum += total + low;
+        }
+        benchmark::DoNotOptimize(checksum);
+    }
+    set_counters(state);
+}
+
+BENCHMARK(moving_stats_naive)->Apply(sizes);
+BENCHMARK(moving_stats_smite)->Apply(sizes);
+
+/*
+** selecting rows from a large column on every core
+*/
+
+static void par_collect_filter_smite(benchmark::State &state)
+{
+    auto v = make_source<std::vector<value_type>>(state.range(0));
+
+    for (auto _ : state) {
+        auto out = smite::filter(v, is_even) | smite::par::to<std::vector<value_type>>();
+        benchmark::DoNotOptimize(out.data());
+    }
+    set_counters(state);
+}
+
+BENCHMARK(par_collect_filter_smite)->Apply(sizes)->UseRealTime();
+
+/*
+** previewing the first matches of a large column
+*/
+
+static constexpr std::size_t preview_size = 16;
+
+static void preview_hand(benchmark::State &state)
+{
+    auto v = make_source<std::vector<value_type>>(state.range(0));
+
+    for (auto _ : state) {
+        std::vector<value_type> out;
+        for (auto i : v) {
+            if (is_even(i)) {
+                out.push_back(i);
+                if (out.size() == preview_size) {
+                    break;
+                }
+            }
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+    set_counters(state);
+}
+
+static void preview_smite(benchmark::State &state)
+{
+    auto v = make_source<std::vector<value_type>>(state.range(0));
+
+    for (auto _ : state) {
+        auto out = smite::take(smite::filter(v, is_even), preview_size) | smite::to<std::vector<value_type>>();
+        benchmark::DoNotOptimize(out.data());
+    }
+    set_counters(state);
+}
+
+BENCHMARK(preview_hand)->Apply(sizes);
+BENCHMARK(preview_smite)->Apply(sizes);
+
+/*
+** scanning a binary file, read into a vector or mapped
+*/
+
+namespace
+{
+    class records_file
+    {
+    public:
+        explicit records_file(std::size_t size) :
+            _path((std::filesystem::temp_directory_path() / "smite-bench-records.bin").string())
+        {
+            auto v = make_source<std::vector<value_type>>(size);
+            auto file = std::fopen(_path.c_str(), "wb");
+
+            std::fwrite(v.data(), sizeof(value_type), v.size(), file);
+            std::fclose(file);
+        }
+
+        ~records_file()
+        {
+            std::remove(_path.c_str());
+        }
+
+        const std::string &path() const noexcept
+        {
+            return _path;
+        }
+
+    private:
+        std::string _path;
+    };
+}
+
+static void file_scan_read(benchmark::State &state)
+{
+    records_file file(state.range(0));
+
+    for (auto _ : state) {
+        std::vector<value_type> v(state.range(0));
+        auto f = std::fopen(file.path().c_str(), "rb");
+
+        benchmark::DoNotOptimize(std::fread(v.data(), sizeof(value_type), v.size(), f));
+        std::fclose(f);
+        benchmark::DoNotOptimize(smite::sum(smite::filter(v, is_even), std::int64_t{0}));
+    }
+    set_counters(state);
+}
+
+static void file_scan_mmap(benchmark::State &state)
+{
+    records_file file(state.range(0));
+    smite::mmap_options opts;
+
+    opts.access = smite::access_pattern::sequential;
+    for (auto _ : state) {
+        auto records = smite::mmap_records<value_type>(file.path(), opts);
+
+        benchmark::DoNotOptimize(smite::sum(smite::filter(records, is_even), std::int64_t{0}));
+    }
+    set_counters(state);
+}
+
+BENCHMARK(file_scan_read)->Apply(sizes);
+BENCHMARK(file_scan_mmap)->Apply(sizes);
+
+static void file_scan_blocks_hand(benchmark::State &state)
+{
+    records_file file(state.range(0));
+    std::vector<value_type> block(4096);
+
+    for (auto _ : state) {
+        auto fd = ::open(file.path().c_str(), O_RDONLY);
+        std::int64_t total = 0;
+
+        while (auto n = ::read(fd, block.data(), block.size() * sizeof(value_type))) {
+            auto count = static_cast<std::size_t>(n) / sizeof(value_type);
+
+            total += smite::sum(smite::filter(smite::make_range(block.data(), block.data() + count), is_even),
+                                std::int64_t{0});
+        }
+        ::close(fd);
+        benchmark::DoNotOptimize(total);
+    }
+    set_counters(state);
+}
+
+static void file_scan_blocks_smite(benchmark::State &state)
+{
+    records_file file(state.range(0));
+
+    for (auto _ : state) {
+        auto fd = ::open(file.path().c_str(), O_RDONLY);
+        auto blocks = smite::read_blocks(fd, 4096 * sizeof(value_type));
+        auto partials = blocks | smite::make_transform([](auto block) {
+            auto first = reinterpret_cast<const value_type *>(block.begin());
+            auto last = reinterpret_cast<const value_type *>(block.end());
+
+            return smite::sum(smite::filter(smite::make_range(first, last), is_even), std::int64_t{0});
+        });
+
+        benchmark::DoNotOptimize(smite::sum(partials, std::int64_t{0}));
+        ::close(fd);
+    }
+    set_counters(state);
+}
+
+BENCHMARK(file_scan_blocks_hand)->Apply(sizes)->UseRealTime();
+BENCHMARK(file_scan_blocks_smite)->Apply(sizes)->UseRealTime();
+
+/*
+** counting the error lines of a log
+*/
+
+namespace
+{
+    std::string make_log(std::size_t lines)
+    {
+        std::mt19937 gen(42);
+        std::uniform_int_distribution<std::size_t> length(20, 120);
+        std::string log;
+
+        for (std::size_t i = 0; i < lines; ++i) {
+            log += i % 7 == 0 ? "ERROR " : "INFO ";
+            log.append(length(gen), 'x');
+            log += '\n';
+        }
+        return log;
+    }
+
+    constexpr auto is_error = [](std::string_view line) {
+        return line.rfind("ERROR", 0) == 0;
+    };
+}
+
+static void log_errors_bytes(benchmark::State &state)
+{
+    auto log = make_log(state.range(0));
+
+    for (auto _ : state) {
+        std::ptrdiff_t errors = 0;
+        std::size_t start = 0;
+
+        for (std::size_t i = 0; i < log.size(); ++i) {
+            if (log[i] == '\n') {
+                errors += is_error(std::string_view(log).substr(start, i - start));
+                start = i + 1;
+            }
+        }
+        benchmark::DoNotOptimize(errors);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * log.size()));
+}
+
+static void log_errors_memchr(benchmark::State &state)
+{
+    auto log = make_log(state.range(0));
+
+    for (auto _ : state) {
+        std::ptrdiff_t errors = 0;
+        const char *first = log.data();
+        const char *last = log.data() + log.size();
+
+        while (first != last) {
+            auto next = static_cast<const char *>(std::memchr(first, '\n', static_cast<std::size_t>(last - first)));
+
+            next = next != nullptr ? next : last;
+            errors += is_error(std::string_view(first, static_cast<std::size_t>(next - first)));
+            first = next != last ? next + 1 : last;
+        }
+        benchmark::DoNotOptimize(errors);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * log.size()));
+}
+
+static void log_errors_smite(benchmark::State &state)
+{
+    auto log = make_log(state.range(0));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(smite::count_if(smite::lines(log), is_error));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * log.size()));
+}
+
+BENCHMARK(log_errors_bytes)->RangeMultiplier(16)->Range(1 << 8, 1 << 16);
+BENCHMARK(log_errors_memchr)->RangeMultiplier(16)->Range(1 << 8, 1 << 16);
+BENCHMARK(log_errors_smite)->RangeMultiplier(16)->Range(1 << 8, 1 << 16);
+
+/*
+** sorting key and payload columns
+*/
+
+namespace
+{
+    struct columns
+    {
+        explicit columns(std::size_t size) : keys(size), payload(size)
+        {
+            std::mt19937 gen(42);
+            std::uniform_int_distribution<value_type> dist;
+
+            std::generate(keys.begin(), keys.end(), [&] { return dist(gen); });
+            std::iota(payload.begin(), payload.end(), 0.0);
+        }
+
+        std::vector<value_type> keys;
+        std::vector<double> payload;
+    };
+}
+
+static void zip_sort_scatter(benchmark::State &state)
+{
+    const columns pristine(state.range(0));
+    columns c = pristine;
+    std::vector<std::pair<value_type, double>> rows(state.range(0));
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        c = pristine;
+        state.ResumeTiming();
+        for (std::size_t i = 0; i < rows.size(); ++i) {
+            rows[i] = {c.keys[i], c.payload[i]};
+        }
+        std::sort(rows.begin(), rows.end(), [](const auto &lhs, const auto &rhs) {
+            return lhs.first < rhs.first;
+        });
+        for (std::size_t i = 0; i < rows.size(); ++i) {
+            c.keys[i] = rows[i].first;
+            c.payload[i] = rows[i].second;
+        }
+        benchmark::ClobberMemory();
+    }
+    set_counters(state, 3);
+}
+
+static void zip_sort_smite(benchmark::State &state)
+{
+    const columns pristine(state.range(0));
+    columns c = pristine;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        c = pristine;
+        state.ResumeTiming();
+        auto rng = smite::zip(c.keys, c.payload);
+        std::sort(rng.begin(), rng.end(), [](const auto &lhs, const auto &rhs) {
+            return std::get<0>(lhs) < std::get<0>(rhs);
+        });
+        benchmark::ClobberMemory();
+    }
+    set_counters(state, 3);
+}
+
+BENCHMARK(zip_sort_scatter)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+BENCHMARK(zip_sort_smite)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+
+#define SMITE_BENCHMARK(name)                                                   \
+    BENCHMARK_TEMPLATE(name##_hand, std::vector<value_type>)->Apply(sizes);     \
+    BENCHMARK_TEMPLATE(name##_smite, std::vector<value_type>)->Apply(sizes);    \
+    BENCHMARK_TEMPLATE(name##_hand, std::list<value_type>)->Apply(sizes);       \
+    BENCHMARK_TEMPLATE(name##_smite, std::list<value_type>)->Apply(sizes);      \
+    BENCHMARK_TEMPLATE(name##_hand, raw_array)->Apply(sizes);                   \
+    BENCHMARK_TEMPLATE(name##_smite, raw_array)->Apply(sizes)
+
+SMITE_BENCHMARK(transform);
+SMITE_BENCHMARK(filter);
+SMITE_BENCHMARK(enumerate);
+SMITE_BENCHMARK(zip);
+SMITE_BENCHMARK(step);
+SMITE_BENCHMARK(chain);
+SMITE_BENCHMARK(transform_chain);
+
+BENCHMARK_MAIN();
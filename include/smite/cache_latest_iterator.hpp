@@ -0,0 +1,306 @@
+/*
+** Created by doom on 18/10/26.
+*/
+
+#ifndef SMITE_CACHE_LATEST_ITERATOR_HPP
+#define SMITE_CACHE_LATEST_ITERATOR_HPP
+
+#include <optional>
+#include <utility>
+#include <iterator>
+#include <type_traits>
+#include <smite/range.hpp>
+#include <smite/details/push.hpp>
+
+namespace smite
+{
+    /*
+    ** Computes the element at the current position at most once, and keeps it in the iterator
+    ** until it moves. Useful when the base iterator returns a prvalue that is expensive to make
+    ** and that is dereferenced several times, like a transform under a filter. Whether that is
+    ** worth the copy into the cache depends on the cost of the transform, which only the caller
+    ** knows, so the layer is never inserted on its own.
+    **
+    ** References point into the iterator and die with the next increment, so the iterator is an
+    ** input iterator whatever its base is.
+    */
+    template <typename Iter>
+    class cache_latest_iterator
+    {
+    private:
+        using iterator_traits = std::iterator_traits<Iter>;
+        using cached_type = std::remove_cv_t<std::remove_reference_t<decltype(*std::declval<const Iter &>())>>;
+
+        /*
+        ** Lets the cache be initialized right from the prvalue, without a move.
+        */
+        struct dereference
+        {
+            constexpr operator cached_type() const
+            {
+                return *iter;
+            }
+
+            const Iter &iter;
+        };
+
+    public:
+        using iterator_type = Iter;
+        using difference_type = typename iterator_traits::difference_type;
+        using value_type = cached_type;
+        using reference = cached_type &;
+        using pointer = cached_type *;
+        using iterator_category = std::input_iterator_tag;
+
+        constexpr explicit cache_latest_iterator(Iter iter) : _iter(std::move(iter))
+        {
+        }
+
+        constexpr cache_latest_iterator(const cache_latest_iterator &) = default;
+
+        constexpr cache_latest_iterator(cache_latest_iterator &&) = default;
+
+        /*
+        ** The cached element may be a proxy whose assignment writes through, so it is rebuilt
+        ** instead of assigned.
+        */
+        constexpr cache_latest_iterator &operator=(const cache_latest_iterator &other)
+        {
+            _iter = other._iter;
+            if (other._cache) {
+                _cache.emplace(*other._cache);
+            } else {
+                _cache.reset();
+            }
+            return *this;
+        }
+
+        constexpr cache_latest_iterator &operator=(cache_latest_iterator &&other)
+        {
+            _iter = std::move(other._iter);
+            if (other._cache) {
+                _cache.emplace(std::move(*other._cache));
+            } else {
+                _cache.reset();
+            }
+            return *this;
+        }
+
+        constexpr pointer operator->() const
+        {
+            return &**this;
+        }
+
+        constexpr reference operator*() const
+        {
+            if (!_cache) {
+                _cache.emplace(dereference{_iter});
+            }
+            return *_cache;
+        }
+
+        constexpr cache_latest_iterator &operator++()
+        {
+            ++_iter;
+            _cache.reset();
+            return *this;
+        }
+
+        constexpr const cache_latest_iterator operator++(int)
+        {
+            auto tmp = *this;
+
+            ++*this;
+            return tmp;
+        }
+
+        constexpr cache_latest_iterator &operator--()
+        {
+            --_iter;
+            _cache.reset();
+            return *this;
+        }
+
+        constexpr const cache_latest_iterator operator--(int)
+        {
+            auto tmp = *this;
+
+            --*this;
+            return tmp;
+        }
+
+        constexpr cache_latest_iterator operator+(difference_type n) const
+        {
+            return cache_latest_iterator(_iter + n);
+        }
+
+        constexpr cache_latest_iterator &operator+=(difference_type n)
+        {
+            _iter += n;
+            _cache.reset();
+            return *this;
+        }
+
+        constexpr cache_latest_iterator operator-(difference_type n) const
+        {
+            return cache_latest_iterator(_iter - n);
+        }
+
+        constexpr difference_type operator-(const cache_latest_iterator &other) const
+        {
+            return std::distance(other._iter, _iter);
+        }
+
+        constexpr cache_latest_iterator &operator-=(difference_type n)
+        {
+            _iter -= n;
+            _cache.reset();
+            return *this;
+        }
+
+        constexpr const iterator_type &base() const noexcept
+        {
+            return _iter;
+        }
+
+    private:
+        Iter _iter;
+        mutable std::optional<cached_type> _cache;
+    };
+
+    template <typename Iter>
+    inline constexpr bool operator==(const cache_latest_iterator<Iter> &lhs, const cache_latest_iterator<Iter> &rhs)
+    {
+        return lhs.base() == rhs.base();
+    }
+
+    template <typename Iter>
+    inline constexpr bool operator!=(const cache_latest_iterator<Iter> &lhs, const cache_latest_iterator<Iter> &rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+    template <typename Iter>
+    inline constexpr bool operator<(const cache_latest_iterator<Iter> &lhs, const cache_latest_iterator<Iter> &rhs)
+    {
+        return lhs.base() < rhs.base();
+    }
+
+    template <typename Iter>
+    inline constexpr bool operator>(const cache_latest_iterator<Iter> &lhs, const cache_latest_iterator<Iter> &rhs)
+    {
+        return rhs < lhs;
+    }
+
+    template <typename Iter>
+    inline constexpr bool operator<=(const cache_latest_iterator<Iter> &lhs, const cache_latest_iterator<Iter> &rhs)
+    {
+        return !(rhs < lhs);
+    }
+
+    template <typename Iter>
+    inline constexpr bool operator>=(const cache_latest_iterator<Iter> &lhs, const cache_latest_iterator<Iter> &rhs)
+    {
+        return !(lhs < rhs);
+    }
+
+    template <typename Iter, typename Sentinel>
+    inline constexpr bool operator==(const cache_latest_iterator<Iter> &lhs, const adaptor_sentinel<Sentinel> &rhs)
+    {
+        return lhs.base() == rhs.base();
+    }
+
+    template <typename Iter, typename Sentinel>
+    inline constexpr bool operator==(const adaptor_sentinel<Sentinel> &lhs, const cache_latest_iterator<Iter> &rhs)
+    {
+        return rhs == lhs;
+    }
+
+    template <typename Iter, typename Sentinel>
+    inline constexpr bool operator!=(const cache_latest_iterator<Iter> &lhs, const adaptor_sentinel<Sentinel> &rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+    template <typename Iter, typename Sentinel>
+    inline constexpr bool operator!=(const adaptor_sentinel<Sentinel> &lhs, const cache_latest_iterator<Iter> &rhs)
+    {
+        return !(rhs == lhs);
+    }
+
+    template <typename Iter, typename Sentinel>
+    inline constexpr auto operator-(const adaptor_sentinel<Sentinel> &lhs,
+                                    const cache_latest_iterator<Iter> &rhs) -> decltype(lhs.base() - rhs.base())
+    {
+        return lhs.base() - rhs.base();
+    }
+
+    template <typename Iter, typename Sentinel>
+    inline constexpr auto operator-(const cache_latest_iterator<Iter> &lhs,
+                                    const adaptor_sentinel<Sentinel> &rhs) -> decltype(lhs.base() - rhs.base())
+    {
+        return lhs.base() - rhs.base();
+    }
+
+    namespace details
+    {
+        template <typename Iter>
+        struct sentinel_traits<cache_latest_iterator<Iter>> : adaptor_sentinel_traits<cache_latest_iterator<Iter>>
+        {
+        };
+
+        template <typename Iter>
+        struct is_sized_iterator<cache_latest_iterator<Iter>> : is_sized_iterator<Iter>
+        {
+        };
+
+        /*
+        ** Pushed elements are computed once anyway, so there is nothing to cache, and they are
+        ** passed on as lvalues like the cached ones.
+        */
+        template <typename Iter>
+        struct push_traversal<cache_latest_iterator<Iter>>
+        {
+            static constexpr bool value = true;
+
+            template <typename Sentinel, typename Sink>
+            static constexpr bool run(const cache_latest_iterator<Iter> &first, const Sentinel &last, Sink &sink)
+            {
+                return for_each_until(first.base(), last.base(), [&sink](auto &&value) {
+                    return sink(value);
+                });
+            }
+        };
+    }
+
+    template <typename Iter>
+    inline constexpr auto make_cache_latest_iterator(Iter iter)
+    {
+        return cache_latest_iterator<Iter>(std::move(iter));
+    }
+
+    namespace details
+    {
+        struct cache_latest_maker
+        {
+            using smite_tag = range_maker_tag;
+
+            template <typename Range>
+            constexpr auto operator()(Range &&rng) const
+            {
+                auto first = std::begin(std::forward<Range>(rng));
+                auto last = std::end(std::forward<Range>(rng));
+
+                if constexpr (details::is_common_v<decltype(first), decltype(last)>) {
+                    return make_range(make_cache_latest_iterator(first), make_cache_latest_iterator(last));
+                } else {
+                    return make_range(make_cache_latest_iterator(first), adaptor_sentinel<decltype(last)>(last));
+                }
+            }
+        };
+    }
+
+    inline constexpr details::cache_latest_maker cache_latest;
+}
+
+#endif /* !SMITE_CACHE_LATEST_ITERATOR_HPP */
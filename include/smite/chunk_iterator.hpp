@@ -0,0 +1,376 @@
+/*
+** Created by doom on 18/10/26.
+*/
+
+#ifndef SMITE_CHUNK_ITERATOR_HPP
+#define SMITE_CHUNK_ITERATOR_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <iterator>
+#include <type_traits>
+#include <smite/range.hpp>
+#include <smite/details/fake_ptr.hpp>
+#include <smite/details/contiguous.hpp>
+
+namespace smite
+{
+    namespace details
+    {
+        /*
+        ** Chunks of contiguous storage are views over raw pointers, others are sub-ranges of the
+        ** base iterators.
+        */
+        template <typename Iter, typename = void>
+        struct chunk_traits
+        {
+            using type = range<Iter>;
+
+            static constexpr type make(const Iter &first, const Iter &last)
+            {
+                return type(first, last);
+            }
+        };
+
+        template <typename Iter>
+        struct chunk_traits<Iter, std::enable_if_t<is_contiguous_iterator_v<Iter>>>
+        {
+            using type = range<contiguous_pointer_t<Iter>>;
+
+            static constexpr type make(const Iter &first, const Iter &last)
+            {
+                auto [begin, end] = to_pointers(first, last);
+
+                return type(begin, end);
+            }
+        };
+    }
+
+    template <typename Iter, typename Sentinel = Iter>
+    class chunk_iterator
+    {
+    public:
+        using iterator_type = Iter;
+        using sentinel_type = Sentinel;
+
+    private:
+        using iterator_traits = std::iterator_traits<Iter>;
+
+        static constexpr bool is_random_access = details::is_common_v<Iter, Sentinel> &&
+                                                 details::has_constant_jumps_v<Iter>;
+
+    public:
+        using difference_type = typename iterator_traits::difference_type;
+        using value_type = typename details::chunk_traits<Iter>::type;
+        using reference = value_type;
+        using pointer = details::fake_ptr<value_type>;
+        using iterator_category = std::conditional_t<
+            is_random_access,
+            std::random_access_iterator_tag,
+            std::conditional_t<
+                std::is_base_of_v<std::forward_iterator_tag, typename iterator_traits::iterator_category>,
+                std::forward_iterator_tag,
+                std::input_iterator_tag
+            >
+        >;
+
+        /*
+        ** missing is how many elements the last chunk lacks to be complete, when iter is the end.
+        */
+        constexpr chunk_iterator(Iter iter, std::size_t size, Sentinel end = Sentinel(), difference_type missing = 0) :
+            _iter(iter), _next(iter), _end(end), _size(size), _missing(missing)
+        {
+            _seek_next();
+        }
+
+        constexpr chunk_iterator(const chunk_iterator &) = default;
+
+        constexpr chunk_iterator(chunk_iterator &&) = default;
+
+        constexpr chunk_iterator &operator=(const chunk_iterator &) = default;
+
+        constexpr chunk_iterator &operator=(chunk_iterator &&) = default;
+
+        constexpr pointer operator->() const
+        {
+            return pointer{**this};
+        }
+
+        constexpr reference operator*() const
+        {
+            return details::chunk_traits<Iter>::make(_iter, _next);
+        }
+
+        constexpr reference operator[](difference_type n) const
+        {
+            return *(*this + n);
+        }
+
+    private:
+        constexpr difference_type _stride() const noexcept
+        {
+            return static_cast<difference_type>(_size);
+        }
+
+        /*
+        ** The end of the current chunk is found once per chunk, so that forward bases are walked
+        ** only once.
+        */
+        constexpr void _seek_next()
+        {
+            if constexpr (is_random_access) {
+                _next = _iter + std::min(_stride(), _end - _iter);
+            } else {
+                _next = _iter;
+                for (difference_type i = 0; i < _stride() && _next != _end; ++i) {
+                    ++_next;
+                }
+            }
+        }
+
+    public:
+        constexpr chunk_iterator &operator++()
+        {
+            if constexpr (is_random_access) {
+                _missing = _stride() - (_next - _iter);
+            }
+            _iter = _next;
+            _seek_next();
+            return *this;
+        }
+
+        constexpr const chunk_iterator operator++(int)
+        {
+            auto tmp = *this;
+
+            ++*this;
+            return tmp;
+        }
+
+        template <bool RA = is_random_access, std::enable_if_t<RA, int> = 0>
+        constexpr chunk_iterator &operator--()
+        {
+            return *this += -1;
+        }
+
+        template <bool RA = is_random_access, std::enable_if_t<RA, int> = 0>
+        constexpr const chunk_iterator operator--(int)
+        {
+            auto tmp = *this;
+
+            --*this;
+            return tmp;
+        }
+
+        template <bool RA = is_random_access, std::enable_if_t<RA, int> = 0>
+        constexpr chunk_iterator operator+(difference_type n) const
+        {
+            auto tmp = *this;
+
+            tmp += n;
+            return tmp;
+        }
+
+        template <bool RA = is_random_access, std::enable_if_t<RA, int> = 0>
+        constexpr chunk_iterator &operator+=(difference_type n)
+        {
+            if (n > 0) {
+                auto left = _end - _iter;
+                auto wanted = n * _stride();
+
+                if (wanted >= left) {
+                    _missing = wanted - left;
+                    _iter += left;
+                } else {
+                    _iter += wanted;
+                }
+            } else if (n < 0) {
+                _iter += n * _stride() + _missing;
+                _missing = 0;
+            }
+            _seek_next();
+            return *this;
+        }
+
+        template <bool RA = is_random_access, std::enable_if_t<RA, int> = 0>
+        constexpr chunk_iterator operator-(difference_type n) const
+        {
+            auto tmp = *this;
+
+            tmp -= n;
+            return tmp;
+        }
+
+        template <bool RA = is_random_access, std::enable_if_t<RA, int> = 0>
+        constexpr difference_type operator-(const chunk_iterator &other) const
+        {
+            return (_iter - other._iter + _missing - other._missing) / _stride();
+        }
+
+        template <bool RA = is_random_access, std::enable_if_t<RA, int> = 0>
+        constexpr chunk_iterator &operator-=(difference_type n)
+        {
+            return *this += -n;
+        }
+
+        constexpr const iterator_type &base() const noexcept
+        {
+            return _iter;
+        }
+
+        constexpr const std::size_t &size() const noexcept
+        {
+            return _size;
+        }
+
+        constexpr const sentinel_type &sentinel() const noexcept
+        {
+            return _end;
+        }
+
+    private:
+        Iter _iter;
+        Iter _next;
+        Sentinel _end;
+        std::size_t _size;
+        difference_type _missing;
+    };
+
+    template <typename Iter, typename Sentinel>
+    inline constexpr chunk_iterator<Iter, Sentinel>
+    operator+(typename chunk_iterator<Iter, Sentinel>::difference_type n, const chunk_iterator<Iter, Sentinel> &it)
+    {
+        return it + n;
+    }
+
+    template <typename Iter, typename Sentinel>
+    inline constexpr bool operator==(const chunk_iterator<Iter, Sentinel> &lhs, const chunk_iterator<Iter, Sentinel> &rhs)
+    {
+        return lhs.base() == rhs.base();
+    }
+
+    template <typename Iter, typename Sentinel>
+    inline constexpr bool operator!=(const chunk_iterator<Iter, Sentinel> &lhs, const chunk_iterator<Iter, Sentinel> &rhs)
+    {
+        return !(rhs == lhs);
+    }
+
+    template <typename Iter, typename Sentinel>
+    inline constexpr bool operator<(const chunk_iterator<Iter, Sentinel> &lhs, const chunk_iterator<Iter, Sentinel> &rhs)
+    {
+        return lhs.base() < rhs.base();
+    }
+
+    template <typename Iter, typename Sentinel>
+    inline constexpr bool operator>(const chunk_iterator<Iter, Sentinel> &lhs, const chunk_iterator<Iter, Sentinel> &rhs)
+    {
+        return rhs < lhs;
+    }
+
+    template <typename Iter, typename Sentinel>
+    inline constexpr bool operator<=(const chunk_iterator<Iter, Sentinel> &lhs, const chunk_iterator<Iter, Sentinel> &rhs)
+    {
+        return !(rhs < lhs);
+    }
+
+    template <typename Iter, typename Sentinel>
+    inline constexpr bool operator>=(const chunk_iterator<Iter, Sentinel> &lhs, const chunk_iterator<Iter, Sentinel> &rhs)
+    {
+        return !(lhs < rhs);
+    }
+
+    template <typename Iter, typename Sentinel, typename BaseSentinel>
+    inline constexpr bool operator==(const chunk_iterator<Iter, Sentinel> &lhs, const adaptor_sentinel<BaseSentinel> &rhs)
+    {
+        return lhs.base() == rhs.base();
+    }
+
+    template <typename Iter, typename Sentinel, typename BaseSentinel>
+    inline constexpr bool operator==(const adaptor_sentinel<BaseSentinel> &lhs, const chunk_iterator<Iter, Sentinel> &rhs)
+    {
+        return rhs == lhs;
+    }
+
+    template <typename Iter, typename Sentinel, typename BaseSentinel>
+    inline constexpr bool operator!=(const chunk_iterator<Iter, Sentinel> &lhs, const adaptor_sentinel<BaseSentinel> &rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+    template <typename Iter, typename Sentinel, typename BaseSentinel>
+    inline constexpr bool operator!=(const adaptor_sentinel<BaseSentinel> &lhs, const chunk_iterator<Iter, Sentinel> &rhs)
+    {
+        return !(rhs == lhs);
+    }
+
+    namespace details
+    {
+        template <typename Iter, typename Sentinel>
+        struct sentinel_traits<chunk_iterator<Iter, Sentinel>> : adaptor_sentinel_traits<chunk_iterator<Iter, Sentinel>>
+        {
+        };
+    }
+
+    template <typename Iter, typename Sentinel = Iter>
+    inline constexpr auto make_chunk_iterator(Iter iter, std::size_t size, Sentinel end = Sentinel(),
+                                              typename std::iterator_traits<Iter>::difference_type missing = 0)
+    {
+        return chunk_iterator<Iter, Sentinel>(iter, size, end, missing);
+    }
+
+    /*
+    ** Groups the elements of container by size consecutive ones, the last group holding what is
+    ** left. Groups over contiguous storage are views over raw pointers, which copy nothing. size
+    ** must be positive.
+    */
+    template <typename Container>
+    inline constexpr auto chunk(Container &&container, std::size_t size)
+    {
+        assert(size > 0 && "chunk needs a positive size");
+
+        auto first = std::begin(std::forward<Container>(container));
+        auto last = std::end(std::forward<Container>(container));
+
+        if constexpr (details::is_common_v<decltype(first), decltype(last)> &&
+                      details::has_constant_jumps_v<decltype(first)>) {
+            auto stride = static_cast<decltype(last - first)>(size);
+            auto missing = (stride - (last - first) % stride) % stride;
+
+            return make_range(make_chunk_iterator(first, size, last), make_chunk_iterator(last, size, last, missing));
+        } else if constexpr (details::is_common_v<decltype(first), decltype(last)>) {
+            auto stop = details::make_sentinel(last);
+
+            return make_range(make_chunk_iterator(first, size, stop), make_chunk_iterator(last, size, stop));
+        } else {
+            auto stop = details::make_sentinel(last);
+
+            return make_range(make_chunk_iterator(first, size, stop), adaptor_sentinel<decltype(stop)>(stop));
+        }
+    }
+
+    namespace details
+    {
+        struct chunk_maker
+        {
+            using smite_tag = range_maker_tag;
+
+            template <typename Range>
+            constexpr auto operator()(Range &&rng) const
+            {
+                return chunk(std::forward<Range>(rng), _size);
+            }
+
+            std::size_t _size;
+        };
+    }
+
+    inline constexpr auto make_chunk(std::size_t size)
+    {
+        assert(size > 0 && "chunk needs a positive size");
+        return details::chunk_maker{size};
+    }
+}
+
+#endif /* !SMITE_CHUNK_ITERATOR_HPP */
@@ -0,0 +1,162 @@
+/*
+** Created by doom on 18/10/26.
+*/
+
+#ifndef SMITE_COLLECT_HPP
+#define SMITE_COLLECT_HPP
+
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <smite/range.hpp>
+#include <smite/transform_iterator.hpp>
+#include <smite/enumerate_iterator.hpp>
+#include <smite/cache_latest_iterator.hpp>
+#include <smite/filter_iterator.hpp>
+#include <smite/details/push.hpp>
+
+namespace smite
+{
+    namespace details
+    {
+        template <typename Iter>
+        struct is_filter_iterator : std::false_type
+        {
+        };
+
+        template <typename Iter, typename Predicate, typename Sentinel>
+        struct is_filter_iterator<filter_iterator<Iter, Predicate, Sentinel>> : std::true_type
+        {
+        };
+
+        /*
+        ** Adaptors yielding exactly one element per element of their base.
+        */
+        template <typename Iter>
+        struct is_one_to_one_iterator : std::false_type
+        {
+        };
+
+        template <typename Iter, typename Transformer>
+        struct is_one_to_one_iterator<transform_iterator<Iter, Transformer>> : std::true_type
+        {
+        };
+
+        template <typename Iter>
+        struct is_one_to_one_iterator<enumerate_iterator<Iter>> : std::true_type
+        {
+        };
+
+        template <typename Iter>
+        struct is_one_to_one_iterator<cache_latest_iterator<Iter>> : std::true_type
+        {
+        };
+
+        /*
+        ** The exact size of [first, last) when it is known in constant time, or else the size of the
+        ** unfiltered range beneath, when there is one.
+        */
+        template <typename Iter, typename Sentinel>
+        constexpr std::optional<std::size_t> size_upper_bound(const Iter &first, const Sentinel &last)
+        {
+            if constexpr (is_sized_v<Iter, Sentinel>) {
+                return static_cast<std::size_t>(last - first);
+            } else if constexpr (is_filter_iterator<Iter>::value) {
+                return size_upper_bound(first.base(), first.sentinel());
+            } else if constexpr (is_one_to_one_iterator<Iter>::value) {
+                return size_upper_bound(first.base(), last.base());
+            } else {
+                return std::nullopt;
+            }
+        }
+
+        template <typename Container, typename = void>
+        struct has_reserve : std::false_type
+        {
+        };
+
+        template <typename Container>
+        struct has_reserve<Container, std::void_t<decltype(std::declval<Container &>().reserve(std::size_t{}))>> :
+            std::true_type
+        {
+        };
+
+        template <typename Container, typename Value, typename = void>
+        struct has_emplace_back : std::false_type
+        {
+        };
+
+        template <typename Container, typename Value>
+        struct has_emplace_back<Container, Value, std::void_t<
+            decltype(std::declval<Container &>().emplace_back(std::declval<Value>()))
+        >> : std::true_type
+        {
+        };
+
+        template <typename Container, typename Iter, typename Sentinel>
+        constexpr void append(Container &c, Iter first, const Sentinel &last)
+        {
+            for_each_until(std::move(first), last, [&c](auto &&value) {
+                if constexpr (has_emplace_back<Container, decltype(value)>::value) {
+                    c.emplace_back(std::forward<decltype(value)>(value));
+                } else {
+                    c.insert(c.end(), std::forward<decltype(value)>(value));
+                }
+                return false;
+            });
+        }
+
+        template <typename Container, typename Range>
+        constexpr Container collect(Range &&rng)
+        {
+            auto first = std::begin(rng);
+            auto last = std::end(rng);
+
+            if constexpr (is_sized_v<decltype(first), decltype(last)> &&
+                          is_common_v<decltype(first), decltype(last)> &&
+                          std::is_constructible_v<Container, decltype(first), decltype(last)>) {
+                /*
+                ** Range constructors measure random access ranges before allocating, and copy
+                ** trivial elements in bulk.
+                */
+                return Container(first, last);
+            } else {
+                Container c;
+
+                if constexpr (has_reserve<Container>::value) {
+                    if (auto bound = size_upper_bound(first, last)) {
+                        c.reserve(*bound);
+                    }
+                }
+                append(c, std::move(first), last);
+                return c;
+            }
+        }
+
+        template <typename Container>
+        struct to_maker
+        {
+            using smite_tag = range_maker_tag;
+
+            template <typename Range>
+            constexpr Container operator()(Range &&rng) const
+            {
+                return collect<Container>(std::forward<Range>(rng));
+            }
+        };
+    }
+
+    /*
+    ** Materializes a range into a Container, allocating once when the size of the range, or an
+    ** upper bound of it, is known up front.
+    */
+    template <typename Container>
+    inline constexpr auto to()
+    {
+        return details::to_maker<Container>{};
+    }
+}
+
+#endif /* !SMITE_COLLECT_HPP */
@@ -0,0 +1,69 @@
+/*
+** Created by doom on 18/10/26.
+*/
+
+#ifndef SMITE_DETAILS_COMPRESSED_TUPLE_HPP
+#define SMITE_DETAILS_COMPRESSED_TUPLE_HPP
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <smite/details/storage.hpp>
+
+namespace smite::details
+{
+    template <typename Indices, typename ...Ts>
+    struct compressed_tuple_impl;
+
+    template <std::size_t ...Is, typename ...Ts>
+    struct compressed_tuple_impl<std::index_sequence<Is...>, Ts...> :
+        private storage<Ts, std::integral_constant<std::size_t, Is>>...
+    {
+        template <std::size_t I>
+        using element_base = storage<
+            std::tuple_element_t<I, std::tuple<Ts...>>,
+            std::integral_constant<std::size_t, I>
+        >;
+
+        constexpr compressed_tuple_impl() = default;
+
+        template <typename ...Us, typename = std::enable_if_t<
+            sizeof...(Us) == sizeof...(Ts) && std::conjunction_v<std::is_constructible<Ts, Us &&>...>
+        >>
+        constexpr compressed_tuple_impl(Us &&...us) :
+            storage<Ts, std::integral_constant<std::size_t, Is>>(std::forward<Us>(us))...
+        {
+        }
+
+        constexpr compressed_tuple_impl(const compressed_tuple_impl &) = default;
+
+        constexpr compressed_tuple_impl(compressed_tuple_impl &&) = default;
+
+        constexpr compressed_tuple_impl &operator=(const compressed_tuple_impl &) = default;
+
+        constexpr compressed_tuple_impl &operator=(compressed_tuple_impl &&) = default;
+
+        template <std::size_t I>
+        constexpr decltype(auto) get() & noexcept
+        {
+            return element_base<I>::get();
+        }
+
+        template <std::size_t I>
+        constexpr decltype(auto) get() const & noexcept
+        {
+            return element_base<I>::get();
+        }
+    };
+
+    template <typename ...Ts>
+    struct compressed_tuple : compressed_tuple_impl<std::index_sequence_for<Ts...>, Ts...>
+    {
+        using compressed_tuple_impl<std::index_sequence_for<Ts...>, Ts...>::compressed_tuple_impl;
+
+        static constexpr std::size_t size = sizeof...(Ts);
+    };
+}
+
+#endif /* !SMITE_DETAILS_COMPRESSED_TUPLE_HPP */
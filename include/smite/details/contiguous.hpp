@@ -0,0 +1,102 @@
+/*
+** Created by doom on 18/10/26.
+*/
+
+#ifndef SMITE_DETAILS_CONTIGUOUS_HPP
+#define SMITE_DETAILS_CONTIGUOUS_HPP
+
+#include <iterator>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace smite::details
+{
+    template <typename T>
+    inline constexpr bool is_char_like_v = std::is_same_v<T, char> || std::is_same_v<T, wchar_t> ||
+                                           std::is_same_v<T, char16_t> || std::is_same_v<T, char32_t>;
+
+    template <typename Iter, typename = void>
+    struct is_contiguous_iterator : std::false_type
+    {
+    };
+
+    template <typename T>
+    struct is_contiguous_iterator<T *, void> : std::true_type
+    {
+    };
+
+    template <typename Iter>
+    struct is_contiguous_iterator<Iter, std::enable_if_t<
+        std::is_class_v<Iter> &&
+        std::is_object_v<typename std::iterator_traits<Iter>::value_type> &&
+        !std::is_array_v<typename std::iterator_traits<Iter>::value_type> &&
+        !std::is_abstract_v<typename std::iterator_traits<Iter>::value_type> &&
+        !std::is_same_v<typename std::iterator_traits<Iter>::value_type, bool>
+    >>
+    {
+    private:
+        using value_type = typename std::iterator_traits<Iter>::value_type;
+
+        template <typename Container>
+        static constexpr bool is_iterator_of_v = std::is_same_v<Iter, typename Container::iterator> ||
+                                                 std::is_same_v<Iter, typename Container::const_iterator>;
+
+        static constexpr bool is_string_iterator()
+        {
+            if constexpr (is_char_like_v<value_type>) {
+                return is_iterator_of_v<std::basic_string<value_type>>;
+            } else {
+                return false;
+            }
+        }
+
+    public:
+        static constexpr bool value = is_iterator_of_v<std::vector<value_type>> || is_string_iterator();
+    };
+
+    template <typename Iter>
+    inline constexpr bool is_contiguous_iterator_v = is_contiguous_iterator<Iter>::value;
+
+    template <typename Iter>
+    using contiguous_pointer_t = std::add_pointer_t<
+        std::remove_reference_t<typename std::iterator_traits<Iter>::reference>
+    >;
+
+    /*
+    ** Turns a contiguous [first, last) pair into raw pointers, without ever dereferencing last.
+    */
+    template <typename Iter>
+    inline constexpr auto to_pointers(Iter first, Iter last) noexcept
+    {
+        using pointer = contiguous_pointer_t<Iter>;
+
+        if constexpr (std::is_pointer_v<Iter>) {
+            return std::pair<pointer, pointer>{first, last};
+        } else if (first == last) {
+            return std::pair<pointer, pointer>{nullptr, nullptr};
+        } else {
+            pointer p = std::addressof(*first);
+
+            return std::pair<pointer, pointer>{p, p + (last - first)};
+        }
+    }
+
+    /*
+    ** Loops over raw pointers skip the checks of debug iterators, and give the optimizer plain
+    ** addresses to reason about. Other ranges are left as they are.
+    */
+    template <typename Iter, typename Sentinel>
+    inline constexpr auto unwrap_contiguous(Iter first, Sentinel last) noexcept
+    {
+        if constexpr (std::is_same_v<Iter, Sentinel> && is_contiguous_iterator_v<Iter>) {
+            return to_pointers(std::move(first), std::move(last));
+        } else {
+            return std::pair<Iter, Sentinel>{std::move(first), std::move(last)};
+        }
+    }
+}
+
+#endif /* !SMITE_DETAILS_CONTIGUOUS_HPP */
@@ -0,0 +1,213 @@
+/*
+** Created by doom on 18/10/26.
+*/
+
+#ifndef SMITE_DETAILS_INDEXED_ACCESS_HPP
+#define SMITE_DETAILS_INDEXED_ACCESS_HPP
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <iterator>
+#include <type_traits>
+#include <smite/range.hpp>
+#include <smite/transform_iterator.hpp>
+#include <smite/enumerate_iterator.hpp>
+#include <smite/zip_iterator.hpp>
+#include <smite/multistep_iterator.hpp>
+#include <smite/details/contiguous.hpp>
+
+/*
+** Looks through transform, enumerate, zip and step layers down to the contiguous arrays beneath them,
+** and rebuilds the elements of the range from plain indices into those arrays. Loops written
+** over an index and raw pointers are the ones compilers know how to vectorize.
+*/
+
+namespace smite::details
+{
+    template <typename Iter, typename = void>
+    struct indexed_access
+    {
+        static constexpr bool value = false;
+    };
+
+    template <typename T>
+    struct pointer_access
+    {
+        constexpr T &operator()(std::ptrdiff_t i) const noexcept
+        {
+            return ptr[i];
+        }
+
+        T *ptr;
+    };
+
+    template <typename Iter>
+    struct indexed_access<Iter, std::enable_if_t<is_contiguous_iterator_v<Iter>>>
+    {
+        static constexpr bool value = true;
+
+        /*
+        ** Dereferences it, which must thus not be past the end.
+        */
+        static constexpr auto make(const Iter &it) noexcept
+        {
+            return pointer_access<std::remove_reference_t<decltype(*it)>>{std::addressof(*it)};
+        }
+    };
+
+    template <typename Access, typename Transformer>
+    struct transform_access
+    {
+        constexpr decltype(auto) operator()(std::ptrdiff_t i) const
+        {
+            return transformer(access(i));
+        }
+
+        Access access;
+        const Transformer &transformer;
+    };
+
+    template <typename Iter, typename Transformer>
+    struct indexed_access<transform_iterator<Iter, Transformer>, std::enable_if_t<indexed_access<Iter>::value>>
+    {
+        static constexpr bool value = true;
+
+        static constexpr auto make(const transform_iterator<Iter, Transformer> &it)
+        {
+            using access_type = decltype(indexed_access<Iter>::make(it.base()));
+
+            return transform_access<access_type, Transformer>{indexed_access<Iter>::make(it.base()), it.transformer()};
+        }
+    };
+
+    template <typename Access, typename Reference>
+    struct enumerate_access
+    {
+        constexpr Reference operator()(std::ptrdiff_t i) const
+        {
+            return Reference{start + i, access(i)};
+        }
+
+        Access access;
+        std::ptrdiff_t start;
+    };
+
+    template <typename Iter>
+    struct indexed_access<enumerate_iterator<Iter>, std::enable_if_t<indexed_access<Iter>::value>>
+    {
+        static constexpr bool value = true;
+
+        static constexpr auto make(const enumerate_iterator<Iter> &it)
+        {
+            using access_type = decltype(indexed_access<Iter>::make(it.base()));
+            using reference = typename enumerate_iterator<Iter>::reference;
+
+            return enumerate_access<access_type, reference>{indexed_access<Iter>::make(it.base()), it.count()};
+        }
+    };
+
+    template <typename Reference, typename ...Accesses>
+    struct zip_access
+    {
+        constexpr Reference operator()(std::ptrdiff_t i) const
+        {
+            return _at(i, std::index_sequence_for<Accesses...>{});
+        }
+
+        template <std::size_t ...Is>
+        constexpr Reference _at(std::ptrdiff_t i, std::index_sequence<Is...>) const
+        {
+            return Reference(std::get<Is>(accesses)(i)...);
+        }
+
+        std::tuple<Accesses...> accesses;
+    };
+
+    template <typename ...Iters>
+    struct indexed_access<zip_iterator<Iters...>, std::enable_if_t<(indexed_access<Iters>::value && ...)>>
+    {
+        static constexpr bool value = true;
+
+        static constexpr auto make(const zip_iterator<Iters...> &it)
+        {
+            return _make(it, std::index_sequence_for<Iters...>{});
+        }
+
+        template <std::size_t ...Is>
+        static constexpr auto _make(const zip_iterator<Iters...> &it, std::index_sequence<Is...>)
+        {
+            using reference = typename zip_iterator<Iters...>::reference;
+
+            return zip_access<reference, decltype(indexed_access<Iters>::make(it.template base<Is>()))...>{
+                std::make_tuple(indexed_access<Iters>::make(it.template base<Is>())...)
+            };
+        }
+    };
+
+    template <typename Access, std::size_t Stride>
+    struct step_access
+    {
+        constexpr decltype(auto) operator()(std::ptrdiff_t i) const
+        {
+            return access(i * static_cast<std::ptrdiff_t>(Stride));
+        }
+
+        Access access;
+    };
+
+    template <typename Access>
+    struct step_access<Access, 0>
+    {
+        constexpr decltype(auto) operator()(std::ptrdiff_t i) const
+        {
+            return access(i * stride);
+        }
+
+        Access access;
+        std::ptrdiff_t stride;
+    };
+
+    template <typename Iter, std::size_t Stride>
+    struct indexed_access<multistep_iterator<Iter, Iter, Stride>, std::enable_if_t<indexed_access<Iter>::value>>
+    {
+        static constexpr bool value = true;
+
+        static constexpr auto make(const multistep_iterator<Iter, Iter, Stride> &it)
+        {
+            using access_type = decltype(indexed_access<Iter>::make(it.base()));
+
+            if constexpr (Stride == 0) {
+                return step_access<access_type, 0>{
+                    indexed_access<Iter>::make(it.base()), static_cast<std::ptrdiff_t>(it.step())
+                };
+            } else {
+                return step_access<access_type, Stride>{indexed_access<Iter>::make(it.base())};
+            }
+        }
+    };
+
+    /*
+    ** A range can be traversed by index when its ends are of the same random access type and when
+    ** it can be seen through down to contiguous memory.
+    */
+    template <typename Iter, typename Sentinel>
+    inline constexpr bool is_indexable_v = [] {
+        if constexpr (is_common_v<Iter, Sentinel>) {
+            return indexed_access<Iter>::value && std::is_base_of_v<
+                std::random_access_iterator_tag,
+                typename std::iterator_traits<Iter>::iterator_category
+            >;
+        } else {
+            return false;
+        }
+    }();
+
+    template <typename Iter>
+    inline constexpr auto make_indexed_access(const Iter &it)
+    {
+        return indexed_access<Iter>::make(it);
+    }
+}
+
+#endif /* !SMITE_DETAILS_INDEXED_ACCESS_HPP */
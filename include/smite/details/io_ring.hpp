@@ -0,0 +1,306 @@
+/*
+** Created by doom on 18/10/26.
+*/
+
+#ifndef SMITE_DETAILS_IO_RING_HPP
+#define SMITE_DETAILS_IO_RING_HPP
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <system_error>
+#include <utility>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#endif
+
+#if defined(IORING_OFF_SQ_RING) && defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define SMITE_HAS_IO_RING 1
+#endif
+
+namespace smite::details
+{
+#ifdef SMITE_HAS_IO_RING
+
+    /*
+    ** A minimal io_uring instance, driven through raw system calls so that liburing is not needed,
+    ** which only reads. Kernels may lack io_uring or forbid it: a ring which could not be set up is
+    ** invalid, and callers fall back to plain system calls.
+    */
+    class io_ring
+    {
+    public:
+        struct completion
+        {
+            std::uint64_t user_data;
+            std::int32_t result;
+        };
+
+        io_ring() noexcept = default;
+
+        /*
+        ** Kernels which predate plain reads, added along with reads at the current position, are
+        ** not used either.
+        */
+        explicit io_ring(unsigned entries) noexcept
+        {
+            io_uring_params params{};
+            auto fd = ::syscall(__NR_io_uring_setup, entries, &params);
+
+            if (fd < 0) {
+                return;
+            }
+            _fd = static_cast<int>(fd);
+            if ((params.features & IORING_FEAT_RW_CUR_POS) == 0 || !_map(params)) {
+                _release();
+            }
+        }
+
+        io_ring(const io_ring &) = delete;
+
+        io_ring(io_ring &&other) noexcept
+        {
+            _take(other);
+        }
+
+        io_ring &operator=(const io_ring &) = delete;
+
+        io_ring &operator=(io_ring &&other) noexcept
+        {
+            if (this != &other) {
+                _release();
+                _take(other);
+            }
+            return *this;
+        }
+
+        ~io_ring()
+        {
+            _release();
+        }
+
+        bool valid() const noexcept
+        {
+            return _fd >= 0;
+        }
+
+        /*
+        ** How many reads can be queued at once.
+        */
+        unsigned entries() const noexcept
+        {
+            return _sq_entries;
+        }
+
+        /*
+        ** Queues a read of size bytes at offset, to be submitted along with the next wait. Returns
+        ** false when the submission queue is full.
+        */
+        bool read(int fd, void *buffer, std::size_t size, std::uint64_t offset, std::uint64_t user_data) noexcept
+        {
+            auto tail = *_sq_tail;
+
+            if (tail - __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE) == _sq_entries) {
+                return false;
+            }
+
+            auto index = tail & _sq_mask;
+            auto &sqe = _sqes[index];
+
+            sqe = io_uring_sqe{};
+            sqe.opcode = IORING_OP_READ;
+            sqe.fd = fd;
+            sqe.addr = reinterpret_cast<std::uint64_t>(buffer);
+            sqe.len = static_cast<std::uint32_t>(size);
+            sqe.off = offset;
+            sqe.user_data = user_data;
+            _sq_array[index] = index;
+            __atomic_store_n(_sq_tail, tail + 1, __ATOMIC_RELEASE);
+            ++_queued;
+            return true;
+        }
+
+        /*
+        ** Submits the queued reads, and returns the oldest completion, waiting for one if there is
+        ** none yet. Throws std::system_error when the kernel refuses the submission.
+        */
+        completion wait()
+        {
+            for (;;) {
+                auto head = *_cq_head;
+
+                if (head != __atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE)) {
+                    const auto &cqe = _cqes[head & _cq_mask];
+                    completion done{cqe.user_data, cqe.res};
+
+                    __atomic_store_n(_cq_head, head + 1, __ATOMIC_RELEASE);
+                    return done;
+                }
+
+                auto submitted = ::syscall(__NR_io_uring_enter, _fd, _queued, 1u, IORING_ENTER_GETEVENTS, nullptr, 0);
+
+                if (submitted < 0 && errno != EINTR) {
+                    throw std::system_error(errno, std::generic_category(), "smite: cannot submit reads");
+                }
+                if (submitted > 0) {
+                    _queued -= static_cast<unsigned>(submitted);
+                }
+            }
+        }
+
+    private:
+        static void *_map_region(int fd, std::size_t size, off_t offset) noexcept
+        {
+            auto region = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+
+            return region == MAP_FAILED ? nullptr : region;
+        }
+
+        template <typename T>
+        static T *_at(void *region, std::uint32_t offset) noexcept
+        {
+            return reinterpret_cast<T *>(static_cast<char *>(region) + offset);
+        }
+
+        bool _map(const io_uring_params &params) noexcept
+        {
+            _sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            _cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0) {
+                _sq_size = _cq_size = std::max(_sq_size, _cq_size);
+            }
+            _sq_ring = _map_region(_fd, _sq_size, IORING_OFF_SQ_RING);
+            if (_sq_ring == nullptr) {
+                return false;
+            }
+            if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0) {
+                _cq_ring = _sq_ring;
+            } else if ((_cq_ring = _map_region(_fd, _cq_size, IORING_OFF_CQ_RING)) == nullptr) {
+                return false;
+            }
+            _sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+            _sqes = static_cast<io_uring_sqe *>(_map_region(_fd, _sqes_size, IORING_OFF_SQES));
+            if (_sqes == nullptr) {
+                return false;
+            }
+            _sq_head = _at<unsigned>(_sq_ring, params.sq_off.head);
+            _sq_tail = _at<unsigned>(_sq_ring, params.sq_off.tail);
+            _sq_array = _at<unsigned>(_sq_ring, params.sq_off.array);
+            _sq_mask = *_at<unsigned>(_sq_ring, params.sq_off.ring_mask);
+            _sq_entries = params.sq_entries;
+            _cq_head = _at<unsigned>(_cq_ring, params.cq_off.head);
+            _cq_tail = _at<unsigned>(_cq_ring, params.cq_off.tail);
+            _cqes = _at<io_uring_cqe>(_cq_ring, params.cq_off.cqes);
+            _cq_mask = *_at<unsigned>(_cq_ring, params.cq_off.ring_mask);
+            return true;
+        }
+
+        void _take(io_ring &other) noexcept
+        {
+            _fd = std::exchange(other._fd, -1);
+            _sq_ring = std::exchange(other._sq_ring, nullptr);
+            _cq_ring = std::exchange(other._cq_ring, nullptr);
+            _sqes = std::exchange(other._sqes, nullptr);
+            _sq_size = other._sq_size;
+            _cq_size = other._cq_size;
+            _sqes_size = other._sqes_size;
+            _sq_head = other._sq_head;
+            _sq_tail = other._sq_tail;
+            _sq_array = other._sq_array;
+            _sq_mask = other._sq_mask;
+            _sq_entries = other._sq_entries;
+            _cq_head = other._cq_head;
+            _cq_tail = other._cq_tail;
+            _cqes = other._cqes;
+            _cq_mask = other._cq_mask;
+            _queued = std::exchange(other._queued, 0);
+        }
+
+        void _release() noexcept
+        {
+            if (_sqes != nullptr) {
+                ::munmap(_sqes, _sqes_size);
+            }
+            if (_cq_ring != nullptr && _cq_ring != _sq_ring) {
+                ::munmap(_cq_ring, _cq_size);
+            }
+            if (_sq_ring != nullptr) {
+                ::munmap(_sq_ring, _sq_size);
+            }
+            if (_fd >= 0) {
+                ::close(_fd);
+            }
+            _fd = -1;
+            _sq_ring = _cq_ring = nullptr;
+            _sqes = nullptr;
+        }
+
+        int _fd = -1;
+        void *_sq_ring = nullptr;
+        void *_cq_ring = nullptr;
+        io_uring_sqe *_sqes = nullptr;
+        std::size_t _sq_size = 0;
+        std::size_t _cq_size = 0;
+        std::size_t _sqes_size = 0;
+        unsigned *_sq_head = nullptr;
+        unsigned *_sq_tail = nullptr;
+        unsigned *_sq_array = nullptr;
+        unsigned _sq_mask = 0;
+        unsigned _sq_entries = 0;
+        unsigned *_cq_head = nullptr;
+        unsigned *_cq_tail = nullptr;
+        io_uring_cqe *_cqes = nullptr;
+        unsigned _cq_mask = 0;
+        unsigned _queued = 0;
+    };
+
+#else
+
+    /*
+    ** Without io_uring, rings are never valid.
+    */
+    class io_ring
+    {
+    public:
+        struct completion
+        {
+            std::uint64_t user_data;
+            std::int32_t result;
+        };
+
+        io_ring() noexcept = default;
+
+        explicit io_ring(unsigned) noexcept
+        {
+        }
+
+        bool valid() const noexcept
+        {
+            return false;
+        }
+
+        unsigned entries() const noexcept
+        {
+            return 0;
+        }
+
+        bool read(int, void *, std::size_t, std::uint64_t, std::uint64_t) noexcept
+        {
+            return false;
+        }
+
+        completion wait()
+        {
+            throw std::system_error(ENOSYS, std::generic_category(), "smite: io_uring is not available");
+        }
+    };
+
+#endif
+}
+
+#endif /* !SMITE_DETAILS_IO_RING_HPP */
@@ -0,0 +1,51 @@
+/*
+** Created by doom on 18/10/26.
+*/
+
+#ifndef SMITE_DETAILS_PUSH_HPP
+#define SMITE_DETAILS_PUSH_HPP
+
+#include <utility>
+#include <type_traits>
+#include <smite/details/contiguous.hpp>
+
+/*
+** Internal iteration: instead of pulling elements through every layer of a chain of adaptors,
+** with an end check and a dereference per layer, the innermost loop runs over the bare base
+** iterators and pushes every element through the layers, each one calling the next as a plain
+** function. Adaptors opt in by specializing push_traversal with a run(first, last, sink)
+** function, where last is either an iterator of the same adaptor or an adaptor_sentinel.
+**
+** Sinks return true to stop the traversal, which then returns true as well. Contiguous bases are
+** traversed through raw pointers.
+*/
+
+namespace smite::details
+{
+    template <typename Iter, typename = void>
+    struct push_traversal
+    {
+        static constexpr bool value = false;
+    };
+
+    template <typename Iter, typename Sentinel, typename Sink>
+    constexpr bool for_each_until(Iter first, const Sentinel &last, Sink &&sink)
+    {
+        if constexpr (std::is_same_v<Iter, Sentinel> && is_contiguous_iterator_v<Iter> && !std::is_pointer_v<Iter>) {
+            auto [begin, end] = to_pointers(std::move(first), last);
+
+            return for_each_until(begin, end, sink);
+        } else if constexpr (push_traversal<Iter>::value) {
+            return push_traversal<Iter>::run(std::move(first), last, sink);
+        } else {
+            for (; first != last; ++first) {
+                if (sink(*first)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+    }
+}
+
+#endif /* !SMITE_DETAILS_PUSH_HPP */
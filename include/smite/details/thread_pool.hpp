@@ -0,0 +1,273 @@
+/*
+** Created by doom on 18/10/26.
+*/
+
+#ifndef SMITE_DETAILS_THREAD_POOL_HPP
+#define SMITE_DETAILS_THREAD_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace smite::details
+{
+    /*
+    ** Every worker owns a queue. It pushes and pops its own tasks at the back, and when it runs out
+    ** it steals from the front of the others' queues. Threads outside the pool spread their tasks
+    ** over the queues, and help running them while they wait for a batch to complete, so that
+    ** nested batches cannot starve the pool. Idle workers and waiting threads sleep on condition
+    ** variables until there is something for them.
+    */
+    class thread_pool
+    {
+    public:
+        using task_type = std::function<void()>;
+
+        explicit thread_pool(std::size_t threads = std::max(1u, std::thread::hardware_concurrency()))
+        {
+            threads = std::max<std::size_t>(threads, 1);
+            for (std::size_t i = 0; i < threads; ++i) {
+                _queues.emplace_back(std::make_unique<queue>());
+            }
+            for (std::size_t i = 0; i < threads; ++i) {
+                _threads.emplace_back([this, i] { _work(i); });
+            }
+        }
+
+        thread_pool(const thread_pool &) = delete;
+
+        thread_pool &operator=(const thread_pool &) = delete;
+
+        ~thread_pool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(_sleep_mutex);
+                _stopping = true;
+            }
+            _wake.notify_all();
+            for (auto &thread : _threads) {
+                thread.join();
+            }
+        }
+
+        std::size_t size() const noexcept
+        {
+            return _threads.size();
+        }
+
+        void submit(task_type task)
+        {
+            auto index = _current_worker();
+            auto &q = *_queues[index < size() ? index : _next_queue++ % size()];
+
+            {
+                std::lock_guard<std::mutex> lock(q.mutex);
+
+                _pending.fetch_add(1, std::memory_order_relaxed);
+                q.tasks.push_back(std::move(task));
+            }
+            _notify_idle();
+        }
+
+        /*
+        ** Runs one queued task, if there is any, on the calling thread.
+        */
+        bool run_pending_task()
+        {
+            auto index = _current_worker();
+            task_type task;
+
+            if (index < size() && _pop(*_queues[index], task, true)) {
+                return _run(task);
+            }
+            for (std::size_t i = 0; i < size(); ++i) {
+                auto victim = (index < size() ? index + 1 + i : i) % size();
+
+                if (_pop(*_queues[victim], task, false)) {
+                    return _run(task);
+                }
+            }
+            return false;
+        }
+
+        /*
+        ** Calls f(0) to f(count - 1) on the pool, and returns once they are all done. The first
+        ** exception thrown by one of the calls is rethrown here.
+        */
+        template <typename Function>
+        void run_batch(std::size_t count, Function &&f)
+        {
+            batch state{count};
+
+            for (std::size_t i = 0; i < count; ++i) {
+                submit([&state, &f, i] {
+                    std::exception_ptr error;
+
+                    try {
+                        f(i);
+                    } catch (...) {
+                        error = std::current_exception();
+                    }
+                    state.finish(std::move(error));
+                });
+            }
+            while (!state.done() && run_pending_task()) {
+            }
+            state.wait();
+            if (state.error) {
+                std::rethrow_exception(state.error);
+            }
+        }
+
+        static thread_pool &global()
+        {
+            static thread_pool pool;
+
+            return pool;
+        }
+
+    private:
+        struct queue
+        {
+            std::mutex mutex;
+            std::deque<task_type> tasks;
+        };
+
+        /*
+        ** Once no task of the batch is left in the queues, the waiting thread sleeps until the last
+        ** running one finishes. That one notifies while holding the lock, so that the state, which
+        ** lives on the stack of the waiting thread, outlives the notification.
+        */
+        struct batch
+        {
+            explicit batch(std::size_t count) noexcept : remaining(count)
+            {
+            }
+
+            bool done()
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+
+                return remaining == 0;
+            }
+
+            void finish(std::exception_ptr task_error)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+
+                if (task_error && !error) {
+                    error = std::move(task_error);
+                }
+                if (--remaining == 0) {
+                    finished.notify_all();
+                }
+            }
+
+            void wait()
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+
+                finished.wait(lock, [this] { return remaining == 0; });
+            }
+
+            std::mutex mutex;
+            std::condition_variable finished;
+            std::size_t remaining;
+            std::exception_ptr error;
+        };
+
+        struct worker_identity
+        {
+            const thread_pool *pool;
+            std::size_t index;
+        };
+
+        static worker_identity &_identity() noexcept
+        {
+            thread_local worker_identity identity{nullptr, 0};
+
+            return identity;
+        }
+
+        std::size_t _current_worker() const noexcept
+        {
+            auto &identity = _identity();
+
+            return identity.pool == this ? identity.index : size();
+        }
+
+        bool _pop(queue &q, task_type &task, bool back)
+        {
+            std::lock_guard<std::mutex> lock(q.mutex);
+
+            if (q.tasks.empty()) {
+                return false;
+            }
+            if (back) {
+                task = std::move(q.tasks.back());
+                q.tasks.pop_back();
+            } else {
+                task = std::move(q.tasks.front());
+                q.tasks.pop_front();
+            }
+            _pending.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        static bool _run(task_type &task)
+        {
+            task();
+            return true;
+        }
+
+        /*
+        ** A worker checks for pending tasks and goes to sleep while holding the sleep lock, so
+        ** taking it between publishing a task and notifying makes sure no worker misses it.
+        */
+        void _notify_idle()
+        {
+            {
+                std::lock_guard<std::mutex> lock(_sleep_mutex);
+            }
+            _wake.notify_one();
+        }
+
+        void _work(std::size_t index)
+        {
+            _identity() = worker_identity{this, index};
+            for (;;) {
+                if (run_pending_task()) {
+                    continue;
+                }
+
+                std::unique_lock<std::mutex> lock(_sleep_mutex);
+
+                _wake.wait(lock, [this] {
+                    return _stopping || _pending.load(std::memory_order_relaxed) != 0;
+                });
+                if (_stopping && _pending.load(std::memory_order_relaxed) == 0) {
+                    return;
+                }
+            }
+        }
+
+        std::vector<std::unique_ptr<queue>> _queues;
+        std::vector<std::thread> _threads;
+        std::atomic<std::size_t> _next_queue{0};
+        std::atomic<std::size_t> _pending{0};
+        std::mutex _sleep_mutex;
+        std::condition_variable _wake;
+        bool _stopping = false;
+    };
+}
+
+#endif /* !SMITE_DETAILS_THREAD_POOL_HPP */
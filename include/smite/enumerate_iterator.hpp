@@ -8,6 +8,7 @@
 #include <utility>
 #include <iterator>
 #include <smite/range.hpp>
+#include <smite/details/push.hpp>
 #include <smite/details/fake_ptr.hpp>
 #include <smite/details/compressed_pair.hpp>
 
@@ -25,11 +26,11 @@ namespace smite
         using iterator_type = Iter;
 
     public:
-        using difference_type = typename iterator_type::difference_type;
-        using value_type = typename iterator_type::value_type;
+        using difference_type = typename iterator_traits::difference_type;
+        using value_type = typename iterator_traits::value_type;
         using reference = std::pair<difference_type, typename iterator_traits::reference>;
         using pointer = details::fake_ptr<reference>;
-        using iterator_category = typename iterator_type::iterator_category;
+        using iterator_category = typename iterator_traits::iterator_category;
 
         constexpr enumerate_iterator(iterator_type iter, difference_type start_at) : base_type(iter, start_at)
         {
@@ -83,7 +84,7 @@ namespace smite
             return tmp;
         }
 
-        constexpr enumerate_iterator operator+(difference_type n)
+        constexpr enumerate_iterator operator+(difference_type n) const
         {
             return enumerate_iterator(base() + n, count() + n);
         }
@@ -95,12 +96,12 @@ namespace smite
             return *this;
         }
 
-        constexpr enumerate_iterator operator-(difference_type n)
+        constexpr enumerate_iterator operator-(difference_type n) const
         {
             return enumerate_iterator(base() - n, count() - n);
         }
 
-        constexpr difference_type operator-(enumerate_iterator other)
+        constexpr difference_type operator-(enumerate_iterator other) const
         {
             return std::distance(other.base(), base());
         }
@@ -169,6 +170,74 @@ namespace smite
         return !(lhs < rhs);
     }
 
+    template <typename Iter, typename Sentinel>
+    inline constexpr bool operator==(const enumerate_iterator<Iter> &lhs, const adaptor_sentinel<Sentinel> &rhs)
+    {
+        return lhs.base() == rhs.base();
+    }
+
+    template <typename Iter, typename Sentinel>
+    inline constexpr bool operator==(const adaptor_sentinel<Sentinel> &lhs, const enumerate_iterator<Iter> &rhs)
+    {
+        return rhs == lhs;
+    }
+
+    template <typename Iter, typename Sentinel>
+    inline constexpr bool operator!=(const enumerate_iterator<Iter> &lhs, const adaptor_sentinel<Sentinel> &rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+    template <typename Iter, typename Sentinel>
+    inline constexpr bool operator!=(const adaptor_sentinel<Sentinel> &lhs, const enumerate_iterator<Iter> &rhs)
+    {
+        return !(rhs == lhs);
+    }
+
+    template <typename Iter, typename Sentinel>
+    inline constexpr auto operator-(const adaptor_sentinel<Sentinel> &lhs,
+                                    const enumerate_iterator<Iter> &rhs) -> decltype(lhs.base() - rhs.base())
+    {
+        return lhs.base() - rhs.base();
+    }
+
+    template <typename Iter, typename Sentinel>
+    inline constexpr auto operator-(const enumerate_iterator<Iter> &lhs,
+                                    const adaptor_sentinel<Sentinel> &rhs) -> decltype(lhs.base() - rhs.base())
+    {
+        return lhs.base() - rhs.base();
+    }
+
+    namespace details
+    {
+        template <typename Iter>
+        struct sentinel_traits<enumerate_iterator<Iter>> : adaptor_sentinel_traits<enumerate_iterator<Iter>>
+        {
+        };
+
+        template <typename Iter>
+        struct is_sized_iterator<enumerate_iterator<Iter>> : is_sized_iterator<Iter>
+        {
+        };
+
+        template <typename Iter>
+        struct push_traversal<enumerate_iterator<Iter>>
+        {
+            static constexpr bool value = true;
+
+            template <typename Sentinel, typename Sink>
+            static constexpr bool run(const enumerate_iterator<Iter> &first, const Sentinel &last, Sink &sink)
+            {
+                using reference = typename enumerate_iterator<Iter>::reference;
+                auto count = first.count();
+
+                return for_each_until(first.base(), last.base(), [&count, &sink](auto &&value) {
+                    return sink(reference{count++, std::forward<decltype(value)>(value)});
+                });
+            }
+        };
+    }
+
     template <typename Iter, typename ItTraits = std::iterator_traits<Iter>>
     inline constexpr auto make_enumerate_iterator(Iter iter, typename ItTraits::difference_type start_at = 0)
     {
@@ -181,11 +250,17 @@ namespace smite
         {
             using smite_tag = range_maker_tag;
 
-            template <typename Range, typename ItTraits = std::iterator_traits<typename std::decay_t<Range>::iterator>>
+            template <typename Range, typename ItTraits = std::iterator_traits<decltype(std::begin(std::declval<Range &>()))>>
             constexpr auto operator()(Range &&r, typename ItTraits::difference_type start_at = 0) const
             {
-                return make_range(make_enumerate_iterator(std::begin(std::forward<Range>(r)), start_at),
-                                  make_enumerate_iterator(std::end(std::forward<Range>(r)), -1));
+                auto first = std::begin(std::forward<Range>(r));
+                auto last = std::end(std::forward<Range>(r));
+
+                if constexpr (details::is_common_v<decltype(first), decltype(last)>) {
+                    return make_range(make_enumerate_iterator(first, start_at), make_enumerate_iterator(last, -1));
+                } else {
+                    return make_range(make_enumerate_iterator(first, start_at), adaptor_sentinel<decltype(last)>(last));
+                }
             }
         };
     }
@@ -5,22 +5,106 @@
 #ifndef SMITE_FILTER_ITERATOR_HPP
 #define SMITE_FILTER_ITERATOR_HPP
 
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
 #include <utility>
 #include <iterator>
+#include <type_traits>
 #include <smite/range.hpp>
+#include <smite/details/push.hpp>
+#include <smite/cache_latest_iterator.hpp>
+#include <smite/details/compressed_pair.hpp>
+#include <smite/details/indexed_access.hpp>
+#include <smite/details/storage.hpp>
 
 namespace smite
 {
-    template <typename Iter, typename Predicate>
-    class filter_iterator
+    namespace details
+    {
+        inline constexpr unsigned count_trailing_zeros(std::uint64_t mask) noexcept
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            return static_cast<unsigned>(__builtin_ctzll(mask));
+#else
+            unsigned n = 0;
+
+            while (!(mask & 1u)) {
+                mask >>= 1u;
+                ++n;
+            }
+            return n;
+#endif
+        }
+
+        /*
+        ** Predicate results are widened to int before being branched on or stored. Tests like
+        ** parity fold into single-bit operations on bool, which GCC cannot vectorize, while it
+        ** vectorizes the same operations on int.
+        */
+        template <typename Predicate, typename T>
+        inline constexpr int test_predicate(const Predicate &pred, T &&value)
+        {
+            return static_cast<bool>(pred(std::forward<T>(value)));
+        }
+
+        /*
+        ** The element type is taken from what dereferencing yields, since some adaptors, like
+        ** enumerate, keep the value type of their base.
+        */
+        template <typename Iter, typename Predicate, typename Sentinel>
+        inline constexpr bool is_batch_filterable_v = [] {
+            using value_type = std::decay_t<typename std::iterator_traits<Iter>::reference>;
+
+            if constexpr (is_sized_v<Iter, Sentinel> && indexed_access<Iter>::value && std::is_arithmetic_v<value_type>) {
+                return std::is_invocable_r_v<bool, const Predicate &, const value_type &>;
+            } else {
+                return false;
+            }
+        }();
+
+        template <typename Iter>
+        struct filter_no_mask
+        {
+        };
+    }
+
+    template <typename Iter, typename Predicate, typename Sentinel = Iter>
+    class filter_iterator :
+        private details::compressed_pair<Iter, details::compressed_pair<Sentinel, Predicate>>,
+        private details::storage<
+            std::conditional_t<
+                details::is_batch_filterable_v<Iter, Predicate, Sentinel>,
+                std::uint64_t,
+                details::filter_no_mask<Iter>
+            >,
+            struct filter_iterator_mask
+        >
     {
     public:
         using iterator_type = Iter;
         using predicate_type = Predicate;
+        using sentinel_type = Sentinel;
 
     private:
+        using base_type = details::compressed_pair<Iter, details::compressed_pair<Sentinel, Predicate>>;
         using iterator_traits = std::iterator_traits<Iter>;
 
+    public:
+        /*
+        ** Over arithmetic data which can be indexed down to contiguous memory, like plain arrays or
+        ** transforms of them, the predicate is evaluated on blocks of elements ahead of the current
+        ** position, computing transformed elements ahead as well. The results are kept in a bitmask
+        ** whose set bits are walked without branching on each individual result. Bits are relative
+        ** to the start of the evaluated block, the lowest set bit is the current element and the
+        ** highest set bit is a guard marking the first element not evaluated yet.
+        */
+        static constexpr bool is_batched = details::is_batch_filterable_v<Iter, Predicate, Sentinel>;
+
+    private:
+        using mask_type = std::conditional_t<is_batched, std::uint64_t, details::filter_no_mask<Iter>>;
+        using mask_base = details::storage<mask_type, struct filter_iterator_mask>;
+
     public:
         using difference_type = typename iterator_traits::difference_type;
         using value_type = typename iterator_traits::value_type;
@@ -28,12 +112,14 @@ namespace smite
         using pointer = typename iterator_traits::pointer;
         using iterator_category = typename iterator_traits::iterator_category;
 
-        constexpr filter_iterator(Iter iter, Predicate pred, Iter end = Iter()) :
-            _iter(iter), _end(end), _predicate(pred)
+    private:
+        static constexpr difference_type block_size = 63;
+
+    public:
+        constexpr filter_iterator(Iter iter, Predicate pred, Sentinel end = Sentinel()) :
+            base_type(iter, details::compressed_pair<Sentinel, Predicate>(end, pred)), mask_base(_empty_mask())
         {
-            while (!_is_satisfying()) {
-                ++_iter;
-            }
+            _seek();
         }
 
         constexpr filter_iterator(const filter_iterator &) = default;
@@ -46,27 +132,99 @@ namespace smite
 
         constexpr pointer operator->() const
         {
-            return _iter;
+            return base();
         }
 
         constexpr reference operator*() const
         {
-            return *_iter;
+            return *base();
         }
 
     private:
+        static constexpr mask_type _empty_mask() noexcept
+        {
+            if constexpr (is_batched) {
+                return 1u;
+            } else {
+                return mask_type{};
+            }
+        }
+
+        constexpr mask_type &_mask() noexcept
+        {
+            return mask_base::get();
+        }
+
         constexpr bool _is_satisfying() const
         {
-            return _iter == _end || _predicate(*_iter);
+            return base() == sentinel() || predicate()(*base());
+        }
+
+        /*
+        ** Predicate results are first stored as bytes, which keeps that loop free of dependencies
+        ** so that it can be vectorized, and then packed eight at a time into the mask.
+        */
+        std::uint64_t _evaluate_block() const
+        {
+            auto n = std::min(sentinel() - base(), block_size);
+            auto access = details::make_indexed_access(base());
+            unsigned char flags[block_size + 1] = {};
+
+            if (n == block_size) {
+                for (difference_type i = 0; i < block_size; ++i) {
+                    flags[i] = static_cast<unsigned char>(details::test_predicate(predicate(), access(i)));
+                }
+            } else {
+                for (difference_type i = 0; i < n; ++i) {
+                    flags[i] = static_cast<unsigned char>(details::test_predicate(predicate(), access(i)));
+                }
+            }
+
+            std::uint64_t bits = 0;
+            for (unsigned i = 0; i < sizeof(flags); i += 8) {
+                std::uint64_t packed;
+
+                std::memcpy(&packed, flags + i, sizeof(packed));
+                bits |= ((packed * 0x0102040810204080u) >> 56u) << i;
+            }
+            return bits | (std::uint64_t{1} << n);
+        }
+
+        static constexpr bool _only_guard_left(std::uint64_t mask) noexcept
+        {
+            return (mask & (mask - 1u)) == 0;
+        }
+
+        constexpr void _seek()
+        {
+            if constexpr (is_batched) {
+                while (_only_guard_left(_mask())) {
+                    if (base() == sentinel()) {
+                        _mask() = 1u;
+                        return;
+                    }
+                    _mask() = _evaluate_block();
+                    base() += details::count_trailing_zeros(_mask());
+                }
+            } else {
+                while (!_is_satisfying()) {
+                    ++base();
+                }
+            }
         }
 
     public:
         constexpr filter_iterator &operator++()
         {
-            ++_iter;
-            while (!_is_satisfying()) {
-                ++_iter;
+            if constexpr (is_batched) {
+                auto current = details::count_trailing_zeros(_mask());
+
+                _mask() &= _mask() - 1u;
+                base() += details::count_trailing_zeros(_mask()) - current;
+            } else {
+                ++base();
             }
+            _seek();
             return *this;
         }
 
@@ -80,9 +238,12 @@ namespace smite
 
         constexpr filter_iterator &operator--()
         {
-            --_iter;
+            --base();
             while (!_is_satisfying()) {
-                --_iter;
+                --base();
+            }
+            if constexpr (is_batched) {
+                _mask() = 3u;
             }
             return *this;
         }
@@ -95,7 +256,7 @@ namespace smite
             return tmp;
         }
 
-        constexpr filter_iterator operator+(difference_type n)
+        constexpr filter_iterator operator+(difference_type n) const
         {
             auto tmp = *this;
 
@@ -111,7 +272,7 @@ namespace smite
             return *this;
         }
 
-        constexpr filter_iterator operator-(difference_type n)
+        constexpr filter_iterator operator-(difference_type n) const
         {
             auto tmp = *this;
 
@@ -119,7 +280,7 @@ namespace smite
             return tmp;
         }
 
-        constexpr difference_type operator-(filter_iterator other)
+        constexpr difference_type operator-(filter_iterator other) const
         {
             auto tmp = *this;
             difference_type n = 0;
@@ -141,76 +302,149 @@ namespace smite
 
         constexpr const iterator_type &base() const noexcept
         {
-            return _iter;
+            return base_type::first();
         }
 
         constexpr iterator_type &base() noexcept
         {
-            return _iter;
+            return base_type::first();
         }
 
         constexpr const predicate_type &predicate() const noexcept
         {
-            return _predicate;
+            return base_type::second().second();
         }
 
-    private:
-        Iter _iter;
-        Iter _end;
-        Predicate _predicate;
+        constexpr const sentinel_type &sentinel() const noexcept
+        {
+            return base_type::second().first();
+        }
     };
 
-    template <typename Iter, typename Predicate>
-    inline constexpr bool operator==(const filter_iterator<Iter, Predicate> &lhs, const filter_iterator<Iter, Predicate> &rhs)
+    template <typename Iter, typename Predicate, typename Sentinel>
+    inline constexpr bool operator==(const filter_iterator<Iter, Predicate, Sentinel> &lhs, const filter_iterator<Iter, Predicate, Sentinel> &rhs)
     {
         return lhs.base() == rhs.base();
     }
 
-    template <typename Iter, typename Predicate>
-    inline constexpr bool operator!=(const filter_iterator<Iter, Predicate> &lhs, const filter_iterator<Iter, Predicate> &rhs)
+    template <typename Iter, typename Predicate, typename Sentinel>
+    inline constexpr bool operator!=(const filter_iterator<Iter, Predicate, Sentinel> &lhs, const filter_iterator<Iter, Predicate, Sentinel> &rhs)
     {
         return !(rhs == lhs);
     }
 
-    template <typename Iter, typename Predicate>
-    inline constexpr bool operator<(const filter_iterator<Iter, Predicate> &lhs, const filter_iterator<Iter, Predicate> &rhs)
+    template <typename Iter, typename Predicate, typename Sentinel>
+    inline constexpr bool operator<(const filter_iterator<Iter, Predicate, Sentinel> &lhs, const filter_iterator<Iter, Predicate, Sentinel> &rhs)
     {
         return lhs.base() < rhs.base();
     }
 
-    template <typename Iter, typename Predicate>
-    inline constexpr bool operator>(const filter_iterator<Iter, Predicate> &lhs, const filter_iterator<Iter, Predicate> &rhs)
+    template <typename Iter, typename Predicate, typename Sentinel>
+    inline constexpr bool operator>(const filter_iterator<Iter, Predicate, Sentinel> &lhs, const filter_iterator<Iter, Predicate, Sentinel> &rhs)
     {
         return rhs < lhs;
     }
 
-    template <typename Iter, typename Predicate>
-    inline constexpr bool operator<=(const filter_iterator<Iter, Predicate> &lhs, const filter_iterator<Iter, Predicate> &rhs)
+    template <typename Iter, typename Predicate, typename Sentinel>
+    inline constexpr bool operator<=(const filter_iterator<Iter, Predicate, Sentinel> &lhs, const filter_iterator<Iter, Predicate, Sentinel> &rhs)
     {
         return !(rhs < lhs);
     }
 
-    template <typename Iter, typename Predicate>
-    inline constexpr bool operator>=(const filter_iterator<Iter, Predicate> &lhs, const filter_iterator<Iter, Predicate> &rhs)
+    template <typename Iter, typename Predicate, typename Sentinel>
+    inline constexpr bool operator>=(const filter_iterator<Iter, Predicate, Sentinel> &lhs, const filter_iterator<Iter, Predicate, Sentinel> &rhs)
     {
         return !(lhs < rhs);
     }
 
-    template <typename Iter, typename Predicate>
-    inline constexpr auto make_filter_iterator(Iter iter, Predicate &&predicate, Iter end = Iter())
+    template <typename Iter, typename Predicate, typename Sentinel, typename BaseSentinel>
+    inline constexpr bool operator==(const filter_iterator<Iter, Predicate, Sentinel> &lhs,
+                                     const adaptor_sentinel<BaseSentinel> &rhs)
+    {
+        return lhs.base() == rhs.base();
+    }
+
+    template <typename Iter, typename Predicate, typename Sentinel, typename BaseSentinel>
+    inline constexpr bool operator==(const adaptor_sentinel<BaseSentinel> &lhs,
+                                     const filter_iterator<Iter, Predicate, Sentinel> &rhs)
+    {
+        return rhs == lhs;
+    }
+
+    template <typename Iter, typename Predicate, typename Sentinel, typename BaseSentinel>
+    inline constexpr bool operator!=(const filter_iterator<Iter, Predicate, Sentinel> &lhs,
+                                     const adaptor_sentinel<BaseSentinel> &rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+    template <typename Iter, typename Predicate, typename Sentinel, typename BaseSentinel>
+    inline constexpr bool operator!=(const adaptor_sentinel<BaseSentinel> &lhs,
+                                     const filter_iterator<Iter, Predicate, Sentinel> &rhs)
+    {
+        return !(rhs == lhs);
+    }
+
+    namespace details
+    {
+        template <typename Iter, typename Predicate, typename Sentinel>
+        struct sentinel_traits<filter_iterator<Iter, Predicate, Sentinel>> :
+            adaptor_sentinel_traits<filter_iterator<Iter, Predicate, Sentinel>>
+        {
+        };
+
+        /*
+        ** The distance between two filter iterators is only known by testing everything in between.
+        */
+        template <typename Iter, typename Predicate, typename Sentinel>
+        struct is_sized_iterator<filter_iterator<Iter, Predicate, Sentinel>> : std::false_type
+        {
+        };
+
+        /*
+        ** Pushed elements are tested and forwarded right away, which makes cache_latest layers
+        ** beneath useless. Batched filters keep walking their masks, which beats branching on
+        ** every element, and have nothing beneath them to push through anyway.
+        */
+        template <typename Iter, typename Predicate, typename Sentinel>
+        struct push_traversal<filter_iterator<Iter, Predicate, Sentinel>>
+        {
+            static constexpr bool value = !filter_iterator<Iter, Predicate, Sentinel>::is_batched;
+
+            template <typename Last, typename Sink>
+            static constexpr bool run(const filter_iterator<Iter, Predicate, Sentinel> &first, const Last &last, Sink &sink)
+            {
+                const auto &pred = first.predicate();
+
+                return for_each_until(first.base(), last.base(), [&pred, &sink](auto &&value) {
+                    return details::test_predicate(pred, value) != 0 && sink(std::forward<decltype(value)>(value));
+                });
+            }
+        };
+    }
+
+    template <typename Iter, typename Predicate, typename Sentinel = Iter>
+    inline constexpr auto make_filter_iterator(Iter iter, Predicate &&predicate, Sentinel end = Sentinel())
     {
-        return filter_iterator<Iter, Predicate>(iter, std::forward<Predicate>(predicate), end);
+        return filter_iterator<Iter, std::decay_t<Predicate>, Sentinel>(iter, std::forward<Predicate>(predicate), end);
     }
 
+    /*
+    ** The predicate and the consumer both dereference the base, so elements computed on the fly
+    ** are computed twice when kept. Putting cache_latest in between computes them only once.
+    */
     template <typename Container, typename Predicate>
     inline constexpr auto filter(Container &&container, Predicate &&predicate)
     {
-        return make_range(
-            make_filter_iterator(std::begin(std::forward<Container>(container)), predicate,
-                                 std::end(std::forward<Container>(container))),
-            make_filter_iterator(std::end(std::forward<Container>(container)), predicate,
-                                 std::end(std::forward<Container>(container)))
-        );
+        auto first = std::begin(std::forward<Container>(container));
+        auto last = std::end(std::forward<Container>(container));
+        auto stop = details::make_sentinel(last);
+
+        if constexpr (details::is_common_v<decltype(first), decltype(last)>) {
+            return make_range(make_filter_iterator(first, predicate, stop), make_filter_iterator(last, predicate, stop));
+        } else {
+            return make_range(make_filter_iterator(first, predicate, stop), adaptor_sentinel<decltype(stop)>(stop));
+        }
     }
 
     namespace details
@@ -235,6 +469,39 @@ namespace smite
     {
         return details::filter_maker<std::decay_t<Predicate>>{std::forward<Predicate>(predicate)};
     }
+
+    namespace details
+    {
+        template <typename First, typename Second>
+        struct conjunction_predicate : private compressed_pair<First, Second>
+        {
+        private:
+            using base_type = compressed_pair<First, Second>;
+
+        public:
+            constexpr conjunction_predicate(First first, Second second) : base_type(std::move(first), std::move(second))
+            {
+            }
+
+            template <typename T>
+            constexpr auto operator()(T &&value) const
+                -> decltype(bool(std::declval<const First &>()(value)) && bool(std::declval<const Second &>()(value)))
+            {
+                return base_type::first()(value) && base_type::second()(value);
+            }
+        };
+
+        /*
+        ** Two filters in a row become a single filter testing p(x) && q(x).
+        */
+        template <typename First, typename Second>
+        inline constexpr auto fuse(const filter_maker<First> &first, const filter_maker<Second> &second)
+        {
+            using predicate_type = conjunction_predicate<First, Second>;
+
+            return filter_maker<predicate_type>{predicate_type(first._predicate, second._predicate)};
+        }
+    }
 }
 
 #endif /* !SMITE_FILTER_ITERATOR_HPP */
@@ -0,0 +1,39 @@
+/*
+** Created by doom on 18/10/26.
+*/
+
+#ifndef SMITE_FOR_EACH_HPP
+#define SMITE_FOR_EACH_HPP
+
+#include <iterator>
+#include <utility>
+#include <smite/range.hpp>
+#include <smite/details/push.hpp>
+
+namespace smite
+{
+    /*
+    ** Calls sink on the elements of rng until it returns true, and returns whether it did. Chains
+    ** of adaptors are traversed from the inside, with a single loop over their base.
+    */
+    template <typename Range, typename Sink>
+    inline constexpr bool for_each_until(Range &&rng, Sink sink)
+    {
+        return details::for_each_until(std::begin(rng), std::end(rng), sink);
+    }
+
+    /*
+    ** Range-for loops always pull elements through every adaptor. This pushes them instead.
+    */
+    template <typename Range, typename Function>
+    inline constexpr Function for_each(Range &&rng, Function f)
+    {
+        details::for_each_until(std::begin(rng), std::end(rng), [&f](auto &&value) {
+            f(std::forward<decltype(value)>(value));
+            return false;
+        });
+        return f;
+    }
+}
+
+#endif /* !SMITE_FOR_EACH_HPP */
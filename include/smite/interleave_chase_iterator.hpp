@@ -0,0 +1,240 @@
+/*
+** Created by doom on 18/10/26.
+*/
+
+#ifndef SMITE_INTERLEAVE_CHASE_ITERATOR_HPP
+#define SMITE_INTERLEAVE_CHASE_ITERATOR_HPP
+
+#include <array>
+#include <cstddef>
+#include <utility>
+#include <iterator>
+#include <type_traits>
+#include <smite/range.hpp>
+#include <smite/join_iterator.hpp>
+#include <smite/details/fake_ptr.hpp>
+
+namespace smite
+{
+    struct interleave_sentinel
+    {
+    };
+
+    /*
+    ** Walks up to Width ranges of a range of ranges at once, taking one element from each in
+    ** turn. Following the links of one list stalls on every miss, but the next nodes of Width
+    ** independent lists can be loaded at the same time, so that walking node-based ranges like
+    ** lists, tree paths or hash buckets this way overlaps their misses. When a range runs out,
+    ** the next one takes its place.
+    **
+    ** Elements come as (index of their range, element) pairs. Those of a given range keep their
+    ** order, while those of different ranges are interleaved.
+    */
+    template <typename Outer, typename OuterSentinel = Outer, std::size_t Width = 8>
+    class interleave_chase_iterator
+    {
+        static_assert(Width != 0, "interleave_chase needs at least one lane");
+
+    private:
+        using traits = details::join_traits<Outer>;
+
+    public:
+        using iterator_type = Outer;
+        using sentinel_type = OuterSentinel;
+        using inner_iterator = typename traits::inner_iterator;
+        using inner_sentinel = typename traits::inner_sentinel;
+
+    private:
+        using inner_traits = std::iterator_traits<inner_iterator>;
+
+        struct lane
+        {
+            inner_iterator iter;
+            inner_sentinel end;
+            std::size_t index;
+        };
+
+    public:
+        using difference_type = std::ptrdiff_t;
+        using value_type = std::pair<std::size_t, typename inner_traits::value_type>;
+        using reference = std::pair<std::size_t, typename inner_traits::reference>;
+        using pointer = details::fake_ptr<reference>;
+        using iterator_category = std::conditional_t<
+            std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<Outer>::iterator_category> &&
+            std::is_base_of_v<std::forward_iterator_tag, typename inner_traits::iterator_category>,
+            std::forward_iterator_tag,
+            std::input_iterator_tag
+        >;
+
+        constexpr interleave_chase_iterator(Outer outer, OuterSentinel end) :
+            _outer(std::move(outer)), _end(std::move(end)), _lanes()
+        {
+            while (_active < Width && _refill(_lanes[_active])) {
+                ++_active;
+            }
+        }
+
+        constexpr interleave_chase_iterator(const interleave_chase_iterator &) = default;
+
+        constexpr interleave_chase_iterator(interleave_chase_iterator &&) = default;
+
+        constexpr interleave_chase_iterator &operator=(const interleave_chase_iterator &) = default;
+
+        constexpr interleave_chase_iterator &operator=(interleave_chase_iterator &&) = default;
+
+        constexpr reference operator*() const
+        {
+            const auto &l = _lanes[_current];
+
+            return reference{l.index, *l.iter};
+        }
+
+        constexpr pointer operator->() const
+        {
+            return pointer{**this};
+        }
+
+        /*
+        ** Lanes whose range ran out with no range left to take its place are replaced by the last
+        ** active lane, so that the active lanes always come first.
+        */
+        constexpr interleave_chase_iterator &operator++()
+        {
+            auto &l = _lanes[_current];
+
+            ++l.iter;
+            if (l.iter == l.end && !_refill(l)) {
+                if (_current != --_active) {
+                    l = std::move(_lanes[_active]);
+                }
+            } else {
+                ++_current;
+            }
+            if (_current >= _active) {
+                _current = 0;
+            }
+            return *this;
+        }
+
+        constexpr const interleave_chase_iterator operator++(int)
+        {
+            auto tmp = *this;
+
+            ++*this;
+            return tmp;
+        }
+
+        constexpr bool done() const noexcept
+        {
+            return _active == 0;
+        }
+
+        constexpr bool operator==(const interleave_chase_iterator &other) const
+        {
+            if (done() || other.done()) {
+                return done() == other.done();
+            }
+
+            const auto &l = _lanes[_current];
+            const auto &r = other._lanes[other._current];
+
+            return l.index == r.index && l.iter == r.iter;
+        }
+
+        constexpr bool operator!=(const interleave_chase_iterator &other) const
+        {
+            return !(*this == other);
+        }
+
+    private:
+        /*
+        ** Gives the lane the next non-empty range, if there is one.
+        */
+        constexpr bool _refill(lane &l)
+        {
+            for (; _outer != _end; ++_outer) {
+                decltype(auto) segment = *_outer;
+
+                l.iter = std::begin(segment);
+                l.end = std::end(segment);
+                l.index = _next_index++;
+                if (l.iter != l.end) {
+                    ++_outer;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        Outer _outer;
+        OuterSentinel _end;
+        std::array<lane, Width> _lanes;
+        std::size_t _active = 0;
+        std::size_t _current = 0;
+        std::size_t _next_index = 0;
+    };
+
+    template <typename Outer, typename OuterSentinel, std::size_t Width>
+    inline constexpr bool operator==(const interleave_chase_iterator<Outer, OuterSentinel, Width> &it,
+                                     interleave_sentinel) noexcept
+    {
+        return it.done();
+    }
+
+    template <typename Outer, typename OuterSentinel, std::size_t Width>
+    inline constexpr bool operator==(interleave_sentinel,
+                                     const interleave_chase_iterator<Outer, OuterSentinel, Width> &it) noexcept
+    {
+        return it.done();
+    }
+
+    template <typename Outer, typename OuterSentinel, std::size_t Width>
+    inline constexpr bool operator!=(const interleave_chase_iterator<Outer, OuterSentinel, Width> &it,
+                                     interleave_sentinel) noexcept
+    {
+        return !it.done();
+    }
+
+    template <typename Outer, typename OuterSentinel, std::size_t Width>
+    inline constexpr bool operator!=(interleave_sentinel,
+                                     const interleave_chase_iterator<Outer, OuterSentinel, Width> &it) noexcept
+    {
+        return !it.done();
+    }
+
+    /*
+    ** Walks the ranges of container Width at a time, round-robin.
+    */
+    template <std::size_t Width = 8, typename Container>
+    inline constexpr auto interleave_chase(Container &&container)
+    {
+        auto first = std::begin(std::forward<Container>(container));
+        auto last = std::end(std::forward<Container>(container));
+        using iterator = interleave_chase_iterator<decltype(first), decltype(last), Width>;
+
+        return make_range(iterator(first, last), interleave_sentinel{});
+    }
+
+    namespace details
+    {
+        template <std::size_t Width>
+        struct interleave_chase_maker
+        {
+            using smite_tag = range_maker_tag;
+
+            template <typename Range>
+            constexpr auto operator()(Range &&rng) const
+            {
+                return interleave_chase<Width>(std::forward<Range>(rng));
+            }
+        };
+    }
+
+    template <std::size_t Width = 8>
+    inline constexpr auto make_interleave_chase()
+    {
+        return details::interleave_chase_maker<Width>{};
+    }
+}
+
+#endif /* !SMITE_INTERLEAVE_CHASE_ITERATOR_HPP */
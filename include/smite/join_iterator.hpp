@@ -0,0 +1,312 @@
+/*
+** Created by doom on 18/10/26.
+*/
+
+#ifndef SMITE_JOIN_ITERATOR_HPP
+#define SMITE_JOIN_ITERATOR_HPP
+
+#include <array>
+#include <cstddef>
+#include <utility>
+#include <iterator>
+#include <type_traits>
+#include <smite/range.hpp>
+#include <smite/details/push.hpp>
+
+namespace smite
+{
+    namespace details
+    {
+        /*
+        ** Containers own their elements, views only point to them.
+        */
+        template <typename T, typename = void>
+        struct is_owning_range : std::false_type
+        {
+        };
+
+        template <typename T>
+        struct is_owning_range<T, std::void_t<typename T::allocator_type>> : std::true_type
+        {
+        };
+
+        template <typename T, std::size_t N>
+        struct is_owning_range<std::array<T, N>> : std::true_type
+        {
+        };
+
+        template <typename Outer>
+        struct join_traits
+        {
+            using segment_reference = typename std::iterator_traits<Outer>::reference;
+            using segment_type = std::remove_reference_t<segment_reference>;
+            using inner_iterator = decltype(std::begin(std::declval<segment_type &>()));
+            using inner_sentinel = decltype(std::end(std::declval<segment_type &>()));
+
+            /*
+            ** Segments yielded by value only live while they are being entered, so their iterators
+            ** must not point into them: they have to be views, like ranges, chunks or string views,
+            ** and not containers.
+            */
+            static_assert(std::is_reference_v<segment_reference> || !is_owning_range<segment_type>::value,
+                          "segments yielded by value must be views");
+        };
+    }
+
+    /*
+    ** Walks the elements of every segment of a range of ranges in turn, skipping empty segments.
+    ** Pushed traversals run one loop per segment, over the bare iterators of that segment, and
+    ** only look at the outer iterator between segments.
+    */
+    template <typename Outer, typename OuterSentinel = Outer>
+    class join_iterator
+    {
+    private:
+        using traits = details::join_traits<Outer>;
+
+    public:
+        using iterator_type = Outer;
+        using sentinel_type = OuterSentinel;
+        using inner_iterator = typename traits::inner_iterator;
+        using inner_sentinel = typename traits::inner_sentinel;
+
+    private:
+        using inner_traits = std::iterator_traits<inner_iterator>;
+
+    public:
+        using difference_type = std::ptrdiff_t;
+        using value_type = typename inner_traits::value_type;
+        using reference = typename inner_traits::reference;
+        using pointer = inner_iterator;
+        using iterator_category = std::conditional_t<
+            std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<Outer>::iterator_category> &&
+            std::is_base_of_v<std::forward_iterator_tag, typename inner_traits::iterator_category>,
+            std::forward_iterator_tag,
+            std::input_iterator_tag
+        >;
+
+        constexpr join_iterator(Outer outer, OuterSentinel end) : _outer(std::move(outer)), _end(std::move(end)),
+                                                                  _inner(), _inner_end()
+        {
+            _seek();
+        }
+
+        constexpr join_iterator(const join_iterator &) = default;
+
+        constexpr join_iterator(join_iterator &&) = default;
+
+        constexpr join_iterator &operator=(const join_iterator &) = default;
+
+        constexpr join_iterator &operator=(join_iterator &&) = default;
+
+        constexpr reference operator*() const
+        {
+            return *_inner;
+        }
+
+        constexpr pointer operator->() const
+        {
+            return _inner;
+        }
+
+        constexpr join_iterator &operator++()
+        {
+            ++_inner;
+            if (_inner == _inner_end) {
+                ++_outer;
+                _seek();
+            }
+            return *this;
+        }
+
+        constexpr const join_iterator operator++(int)
+        {
+            auto tmp = *this;
+
+            ++*this;
+            return tmp;
+        }
+
+        constexpr const iterator_type &base() const noexcept
+        {
+            return _outer;
+        }
+
+        constexpr const sentinel_type &sentinel() const noexcept
+        {
+            return _end;
+        }
+
+        constexpr const inner_iterator &inner() const noexcept
+        {
+            return _inner;
+        }
+
+        constexpr const inner_sentinel &inner_end() const noexcept
+        {
+            return _inner_end;
+        }
+
+    private:
+        /*
+        ** Enters the first non-empty segment from the current outer position on.
+        */
+        constexpr void _seek()
+        {
+            for (; _outer != _end; ++_outer) {
+                decltype(auto) segment = *_outer;
+
+                _inner = std::begin(segment);
+                _inner_end = std::end(segment);
+                if (_inner != _inner_end) {
+                    return;
+                }
+            }
+        }
+
+        Outer _outer;
+        OuterSentinel _end;
+        inner_iterator _inner;
+        inner_sentinel _inner_end;
+    };
+
+    template <typename Outer, typename OuterSentinel>
+    inline constexpr bool operator==(const join_iterator<Outer, OuterSentinel> &lhs, const join_iterator<Outer, OuterSentinel> &rhs)
+    {
+        return lhs.base() == rhs.base() && (lhs.base() == lhs.sentinel() || lhs.inner() == rhs.inner());
+    }
+
+    template <typename Outer, typename OuterSentinel>
+    inline constexpr bool operator!=(const join_iterator<Outer, OuterSentinel> &lhs, const join_iterator<Outer, OuterSentinel> &rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+    template <typename Outer, typename OuterSentinel, typename BaseSentinel>
+    inline constexpr bool operator==(const join_iterator<Outer, OuterSentinel> &lhs, const adaptor_sentinel<BaseSentinel> &rhs)
+    {
+        return lhs.base() == rhs.base();
+    }
+
+    template <typename Outer, typename OuterSentinel, typename BaseSentinel>
+    inline constexpr bool operator==(const adaptor_sentinel<BaseSentinel> &lhs, const join_iterator<Outer, OuterSentinel> &rhs)
+    {
+        return rhs == lhs;
+    }
+
+    template <typename Outer, typename OuterSentinel, typename BaseSentinel>
+    inline constexpr bool operator!=(const join_iterator<Outer, OuterSentinel> &lhs, const adaptor_sentinel<BaseSentinel> &rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+    template <typename Outer, typename OuterSentinel, typename BaseSentinel>
+    inline constexpr bool operator!=(const adaptor_sentinel<BaseSentinel> &lhs, const join_iterator<Outer, OuterSentinel> &rhs)
+    {
+        return !(rhs == lhs);
+    }
+
+    namespace details
+    {
+        template <typename Outer, typename OuterSentinel>
+        struct sentinel_traits<join_iterator<Outer, OuterSentinel>> :
+            adaptor_sentinel_traits<join_iterator<Outer, OuterSentinel>>
+        {
+        };
+
+        /*
+        ** Pushes every segment through its own loop over its bare iterators, starting from the
+        ** rest of the current one, and ending with the part of the last one before last when last
+        ** is an iterator in the middle.
+        */
+        template <typename Outer, typename OuterSentinel>
+        struct push_traversal<join_iterator<Outer, OuterSentinel>>
+        {
+            static constexpr bool value = true;
+
+            template <typename Last, typename Sink>
+            static constexpr bool run(const join_iterator<Outer, OuterSentinel> &first, const Last &last, Sink &sink)
+            {
+                constexpr bool is_iterator = std::is_same_v<Last, join_iterator<Outer, OuterSentinel>>;
+
+                if (first.base() == first.sentinel()) {
+                    return false;
+                }
+                if constexpr (is_iterator) {
+                    if (first.base() == last.base()) {
+                        return for_each_until(first.inner(), last.inner(), sink);
+                    }
+                }
+
+                auto outer = first.base();
+                auto inner = first.inner();
+                auto inner_end = first.inner_end();
+
+                for (;;) {
+                    if (for_each_until(inner, inner_end, sink)) {
+                        return true;
+                    }
+                    ++outer;
+                    if (outer == first.sentinel()) {
+                        return false;
+                    }
+
+                    decltype(auto) segment = *outer;
+
+                    inner = std::begin(segment);
+                    if constexpr (is_iterator) {
+                        if (outer == last.base()) {
+                            return for_each_until(inner, last.inner(), sink);
+                        }
+                    }
+                    inner_end = std::end(segment);
+                }
+            }
+        };
+    }
+
+    template <typename Outer, typename OuterSentinel = Outer>
+    inline constexpr auto make_join_iterator(Outer outer, OuterSentinel end = OuterSentinel())
+    {
+        return join_iterator<Outer, OuterSentinel>(std::move(outer), std::move(end));
+    }
+
+    /*
+    ** Flattens a range of ranges, like a vector of vectors, the chunks of a range or the blocks of
+    ** a reader, into the range of their elements.
+    */
+    template <typename Container>
+    inline constexpr auto join(Container &&container)
+    {
+        auto first = std::begin(std::forward<Container>(container));
+        auto last = std::end(std::forward<Container>(container));
+        auto stop = details::make_sentinel(last);
+
+        if constexpr (details::is_common_v<decltype(first), decltype(last)>) {
+            return make_range(make_join_iterator(first, stop), make_join_iterator(last, stop));
+        } else {
+            return make_range(make_join_iterator(first, stop), adaptor_sentinel<decltype(stop)>(stop));
+        }
+    }
+
+    namespace details
+    {
+        struct join_maker
+        {
+            using smite_tag = range_maker_tag;
+
+            template <typename Range>
+            constexpr auto operator()(Range &&rng) const
+            {
+                return join(std::forward<Range>(rng));
+            }
+        };
+    }
+
+    inline constexpr auto make_join()
+    {
+        return details::join_maker{};
+    }
+}
+
+#endif /* !SMITE_JOIN_ITERATOR_HPP */
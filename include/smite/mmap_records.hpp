@@ -0,0 +1,240 @@
+/*
+** Created by doom on 18/10/26.
+*/
+
+#ifndef SMITE_MMAP_RECORDS_HPP
+#define SMITE_MMAP_RECORDS_HPP
+
+#include <cerrno>
+#include <cstddef>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace smite
+{
+    enum class access_pattern
+    {
+        normal,
+        sequential,
+        random,
+    };
+
+    struct mmap_options
+    {
+        /*
+        ** Tells the kernel how the records will be read, so that it reads ahead aggressively for
+        ** sequential scans, and not at all for random lookups.
+        */
+        access_pattern access = access_pattern::normal;
+
+        /*
+        ** Asks for the mapping to be backed by huge pages, which cuts TLB misses on large files.
+        ** This is only advice: kernels and filesystems which cannot do it ignore it.
+        */
+        bool huge_pages = false;
+
+        /*
+        ** Reads the whole file in when mapping it, instead of faulting its pages in on first use.
+        */
+        bool populate = false;
+    };
+
+    namespace details
+    {
+        /*
+        ** A read-only, private mapping of a whole file, unmapped on destruction.
+        */
+        class file_mapping
+        {
+        public:
+            constexpr file_mapping() noexcept = default;
+
+            file_mapping(const std::string &path, const mmap_options &opts)
+            {
+                auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+                if (fd < 0) {
+                    throw std::system_error(errno, std::generic_category(), "smite: cannot open " + path);
+                }
+
+                struct stat st{};
+
+                if (::fstat(fd, &st) != 0) {
+                    auto error = errno;
+
+                    ::close(fd);
+                    throw std::system_error(error, std::generic_category(), "smite: cannot stat " + path);
+                }
+                _size = static_cast<std::size_t>(st.st_size);
+                if (_size != 0) {
+                    _data = ::mmap(nullptr, _size, PROT_READ, _flags(opts), fd, 0);
+                }
+                auto error = errno;
+
+                ::close(fd);
+                if (_data == MAP_FAILED) {
+                    _data = nullptr;
+                    throw std::system_error(error, std::generic_category(), "smite: cannot map " + path);
+                }
+                if (_data != nullptr) {
+                    _advise(opts);
+                }
+            }
+
+            file_mapping(const file_mapping &) = delete;
+
+            file_mapping &operator=(const file_mapping &) = delete;
+
+            file_mapping(file_mapping &&other) noexcept :
+                _data(std::exchange(other._data, nullptr)), _size(std::exchange(other._size, 0))
+            {
+            }
+
+            file_mapping &operator=(file_mapping &&other) noexcept
+            {
+                if (this != &other) {
+                    _unmap();
+                    _data = std::exchange(other._data, nullptr);
+                    _size = std::exchange(other._size, 0);
+                }
+                return *this;
+            }
+
+            ~file_mapping()
+            {
+                _unmap();
+            }
+
+            const void *data() const noexcept
+            {
+                return _data;
+            }
+
+            std::size_t size() const noexcept
+            {
+                return _size;
+            }
+
+        private:
+            static int _flags(const mmap_options &opts) noexcept
+            {
+                auto flags = MAP_PRIVATE;
+
+#ifdef MAP_POPULATE
+                if (opts.populate) {
+                    flags |= MAP_POPULATE;
+                }
+#else
+                (void)opts;
+#endif
+                return flags;
+            }
+
+            /*
+            ** Advice failing is not an error: the mapping works all the same.
+            */
+            void _advise(const mmap_options &opts) noexcept
+            {
+                switch (opts.access) {
+                    case access_pattern::sequential:
+                        ::madvise(_data, _size, MADV_SEQUENTIAL);
+                        break;
+                    case access_pattern::random:
+                        ::madvise(_data, _size, MADV_RANDOM);
+                        break;
+                    case access_pattern::normal:
+                        break;
+                }
+#ifdef MADV_HUGEPAGE
+                if (opts.huge_pages) {
+                    ::madvise(_data, _size, MADV_HUGEPAGE);
+                }
+#endif
+            }
+
+            void _unmap() noexcept
+            {
+                if (_data != nullptr) {
+                    ::munmap(_data, _size);
+                }
+            }
+
+            void *_data = nullptr;
+            std::size_t _size = 0;
+        };
+    }
+
+    /*
+    ** A file of fixed-width records, mapped in memory and seen as a read-only contiguous range of
+    ** T. Its iterators are raw pointers, so every adaptor works on top of it without copying, and
+    ** pages are only read from disk when first touched. Trailing bytes which do not make a whole
+    ** record are left out.
+    */
+    template <typename T>
+    class mapped_records
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "records must be trivially copyable");
+
+    public:
+        using value_type = T;
+        using iterator = const T *;
+        using const_iterator = const T *;
+
+        mapped_records() noexcept = default;
+
+        mapped_records(const std::string &path, const mmap_options &opts = {}) : _mapping(path, opts)
+        {
+        }
+
+        const T *data() const noexcept
+        {
+            return static_cast<const T *>(_mapping.data());
+        }
+
+        std::size_t size() const noexcept
+        {
+            return _mapping.size() / sizeof(T);
+        }
+
+        bool empty() const noexcept
+        {
+            return size() == 0;
+        }
+
+        const T *begin() const noexcept
+        {
+            return data();
+        }
+
+        const T *end() const noexcept
+        {
+            return data() + size();
+        }
+
+        const T &operator[](std::size_t n) const noexcept
+        {
+            return data()[n];
+        }
+
+    private:
+        details::file_mapping _mapping;
+    };
+
+    /*
+    ** Maps the file at path as records of T, throwing std::system_error when it cannot be opened
+    ** or mapped.
+    */
+    template <typename T>
+    inline mapped_records<T> mmap_records(const std::string &path, const mmap_options &opts = {})
+    {
+        return mapped_records<T>(path, opts);
+    }
+}
+
+#endif /* !SMITE_MMAP_RECORDS_HPP */
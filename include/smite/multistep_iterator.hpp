@@ -5,30 +5,101 @@
 #ifndef SMITE_MULTISTEP_ITERATOR_HPP
 #define SMITE_MULTISTEP_ITERATOR_HPP
 
+#include <algorithm>
+#include <cassert>
 #include <utility>
 #include <iterator>
+#include <type_traits>
 #include <smite/range.hpp>
+#include <smite/details/push.hpp>
 
 namespace smite
 {
-    template <typename Iter>
-    class multistep_iterator
+    namespace details
+    {
+        /*
+        ** Strides known at compile time are part of the type and take no room in the iterator.
+        */
+        template <std::size_t Stride>
+        struct step_storage
+        {
+            constexpr explicit step_storage(std::size_t) noexcept
+            {
+            }
+
+            static constexpr std::size_t step() noexcept
+            {
+                return Stride;
+            }
+        };
+
+        template <>
+        struct step_storage<0>
+        {
+            constexpr explicit step_storage(std::size_t step) noexcept : _step(step)
+            {
+            }
+
+            constexpr std::size_t step() const noexcept
+            {
+                return _step;
+            }
+
+            std::size_t _step;
+        };
+    }
+
+    /*
+    ** A Stride of 0 means that the stride is given at runtime.
+    **
+    ** Over common ranges with constant-time jumps, the position is kept as its signed offset from
+    ** the end of the range, which is never dereferenced past it. Stepping is then a plain addition
+    ** which may go past the end, every offset from there on meaning the end, so that a loop over
+    ** the range has a trip count the compiler can compute, like a hand-written strided loop.
+    ** Over other ranges, the position is kept clamped to the end, like the base iterator it is.
+    ** In both cases, missing is how many more elements one stride would have taken: the end of a
+    ** range whose size is not a multiple of the stride is missing some, and keeps track of them so
+    ** that it can step back.
+    */
+    template <typename Iter, typename Sentinel = Iter, std::size_t Stride = 0>
+    class multistep_iterator : private details::step_storage<Stride>
     {
+    private:
+        using step_base = details::step_storage<Stride>;
+
     public:
         using iterator_type = Iter;
+        using sentinel_type = Sentinel;
 
     private:
         using iterator_traits = std::iterator_traits<Iter>;
 
     public:
+        static constexpr bool is_random_access = details::is_common_v<Iter, Sentinel> &&
+                                                 details::has_constant_jumps_v<Iter>;
+
         using difference_type = typename iterator_traits::difference_type;
         using value_type = typename iterator_traits::value_type;
         using reference = typename iterator_traits::reference;
         using pointer = typename iterator_traits::pointer;
         using iterator_category = typename iterator_traits::iterator_category;
 
-        constexpr multistep_iterator(Iter iter, std::size_t step, Iter end = Iter()) :
-            _iter(iter), _end(end), _step(step)
+    private:
+        using position_type = std::conditional_t<is_random_access, difference_type, Iter>;
+
+        static constexpr position_type _make_position(const Iter &iter, const Sentinel &end)
+        {
+            if constexpr (is_random_access) {
+                return iter - end;
+            } else {
+                static_cast<void>(end);
+                return iter;
+            }
+        }
+
+    public:
+        constexpr multistep_iterator(Iter iter, std::size_t step, Sentinel end = Sentinel(), difference_type missing = 0) :
+            step_base(step), _position(_make_position(iter, end)), _end(end), _missing(missing)
         {
         }
 
@@ -42,19 +113,50 @@ namespace smite
 
         constexpr pointer operator->() const
         {
-            return _iter;
+            return base();
         }
 
         constexpr reference operator*() const
         {
-            return *_iter;
+            if constexpr (is_random_access) {
+                return _end[_position];
+            } else {
+                return *_position;
+            }
+        }
+
+    private:
+        constexpr difference_type _stride() const noexcept
+        {
+            return static_cast<difference_type>(step_base::step());
         }
 
+    public:
+        /*
+        ** Indexing an element of the range never goes past its end, so it needs no clamping.
+        */
+        constexpr reference operator[](difference_type n) const
+        {
+            if constexpr (is_random_access) {
+                return _end[_position + _missing + n * _stride()];
+            } else {
+                return *(*this + n);
+            }
+        }
+
+    public:
         constexpr multistep_iterator &operator++()
         {
-            ++_iter;
-            for (std::size_t i = 1; i < _step && _iter != _end; ++i) {
-                ++_iter;
+            if constexpr (is_random_access) {
+                _position += _stride();
+            } else {
+                difference_type i = 1;
+
+                ++_position;
+                for (; i < _stride() && _position != _end; ++i) {
+                    ++_position;
+                }
+                _missing = _stride() - i;
             }
             return *this;
         }
@@ -69,10 +171,14 @@ namespace smite
 
         constexpr multistep_iterator &operator--()
         {
-            --_iter;
-            for (std::size_t i = 1; i < _step; ++i) {
-                --_iter;
+            if constexpr (is_random_access) {
+                _position += _missing - _stride();
+            } else {
+                for (difference_type i = _missing; i < _stride(); ++i) {
+                    --_position;
+                }
             }
+            _missing = 0;
             return *this;
         }
 
@@ -84,7 +190,7 @@ namespace smite
             return tmp;
         }
 
-        constexpr multistep_iterator operator+(difference_type n)
+        constexpr multistep_iterator operator+(difference_type n) const
         {
             auto tmp = *this;
 
@@ -94,13 +200,21 @@ namespace smite
 
         constexpr multistep_iterator &operator+=(difference_type n)
         {
-            while (n--) {
-                ++*this;
+            if constexpr (is_random_access) {
+                _position += _missing + n * _stride();
+                _missing = 0;
+            } else {
+                for (; n > 0; --n) {
+                    ++*this;
+                }
+                for (; n < 0; ++n) {
+                    --*this;
+                }
             }
             return *this;
         }
 
-        constexpr multistep_iterator operator-(difference_type n)
+        constexpr multistep_iterator operator-(difference_type n) const
         {
             auto tmp = *this;
 
@@ -108,104 +222,266 @@ namespace smite
             return tmp;
         }
 
-        constexpr difference_type operator-(multistep_iterator other)
+        constexpr difference_type operator-(multistep_iterator other) const
         {
-            auto tmp = *this;
-            difference_type n = 0;
-
-            while (tmp.base() != other.base()) {
-                ++other;
-                ++n;
+            if constexpr (is_random_access) {
+                return (_position + _missing - other._position - other._missing) / _stride();
+            } else {
+                difference_type n = 0;
+
+                while (base() != other.base()) {
+                    ++other;
+                    ++n;
+                }
+                return n;
             }
-            return n;
         }
 
         constexpr multistep_iterator &operator-=(difference_type n)
         {
-            while (n--) {
-                --*this;
+            return *this += -n;
+        }
+
+        /*
+        ** The position in the base, clamped to the end of the range.
+        */
+        constexpr decltype(auto) base() const noexcept
+        {
+            if constexpr (is_random_access) {
+                return iterator_type(_end + offset());
+            } else {
+                return static_cast<const iterator_type &>(_position);
             }
-            return *this;
         }
 
-        constexpr const iterator_type &base() const noexcept
+        /*
+        ** The offset of the position from the end of the range, clamped to it, when the range is
+        ** random access.
+        */
+        template <bool RA = is_random_access, std::enable_if_t<RA, int> = 0>
+        constexpr difference_type offset() const noexcept
+        {
+            return std::min(_position, difference_type{0});
+        }
+
+        constexpr std::size_t step() const noexcept
         {
-            return _iter;
+            return step_base::step();
         }
 
-        constexpr iterator_type &base() noexcept
+        constexpr difference_type missing() const noexcept
         {
-            return _iter;
+            if constexpr (is_random_access) {
+                return std::max(_position + _missing, difference_type{0});
+            } else {
+                return _missing;
+            }
         }
 
-        constexpr const std::size_t &step() const noexcept
+        constexpr const sentinel_type &sentinel() const noexcept
         {
-            return _step;
+            return _end;
         }
 
     private:
-        Iter _iter;
-        Iter _end;
-        std::size_t _step;
+        position_type _position;
+        Sentinel _end;
+        difference_type _missing;
     };
 
-    template <typename Iter>
+    template <typename Iter, typename Sentinel, std::size_t Stride>
+    inline constexpr multistep_iterator<Iter, Sentinel, Stride>
+    operator+(typename multistep_iterator<Iter, Sentinel, Stride>::difference_type n, const multistep_iterator<Iter, Sentinel, Stride> &it)
+    {
+        return it + n;
+    }
+
+    template <typename Iter, typename Sentinel, std::size_t Stride>
     inline constexpr bool
-    operator==(const multistep_iterator<Iter> &lhs, const multistep_iterator<Iter> &rhs)
+    operator==(const multistep_iterator<Iter, Sentinel, Stride> &lhs, const multistep_iterator<Iter, Sentinel, Stride> &rhs)
     {
-        return lhs.base() == rhs.base();
+        if constexpr (multistep_iterator<Iter, Sentinel, Stride>::is_random_access) {
+            return lhs.offset() == rhs.offset();
+        } else {
+            return lhs.base() == rhs.base();
+        }
     }
 
-    template <typename Iter>
+    template <typename Iter, typename Sentinel, std::size_t Stride>
     inline constexpr bool
-    operator!=(const multistep_iterator<Iter> &lhs, const multistep_iterator<Iter> &rhs)
+    operator!=(const multistep_iterator<Iter, Sentinel, Stride> &lhs, const multistep_iterator<Iter, Sentinel, Stride> &rhs)
     {
         return !(rhs == lhs);
     }
 
-    template <typename Iter>
+    template <typename Iter, typename Sentinel, std::size_t Stride>
     inline constexpr bool
-    operator<(const multistep_iterator<Iter> &lhs, const multistep_iterator<Iter> &rhs)
+    operator<(const multistep_iterator<Iter, Sentinel, Stride> &lhs, const multistep_iterator<Iter, Sentinel, Stride> &rhs)
     {
-        return lhs.base() < rhs.base();
+        if constexpr (multistep_iterator<Iter, Sentinel, Stride>::is_random_access) {
+            return lhs.offset() < rhs.offset();
+        } else {
+            return lhs.base() < rhs.base();
+        }
     }
 
-    template <typename Iter>
+    template <typename Iter, typename Sentinel, std::size_t Stride>
     inline constexpr bool
-    operator>(const multistep_iterator<Iter> &lhs, const multistep_iterator<Iter> &rhs)
+    operator>(const multistep_iterator<Iter, Sentinel, Stride> &lhs, const multistep_iterator<Iter, Sentinel, Stride> &rhs)
     {
         return rhs < lhs;
     }
 
-    template <typename Iter>
+    template <typename Iter, typename Sentinel, std::size_t Stride>
     inline constexpr bool
-    operator<=(const multistep_iterator<Iter> &lhs, const multistep_iterator<Iter> &rhs)
+    operator<=(const multistep_iterator<Iter, Sentinel, Stride> &lhs, const multistep_iterator<Iter, Sentinel, Stride> &rhs)
     {
         return !(rhs < lhs);
     }
 
-    template <typename Iter>
+    template <typename Iter, typename Sentinel, std::size_t Stride>
     inline constexpr bool
-    operator>=(const multistep_iterator<Iter> &lhs, const multistep_iterator<Iter> &rhs)
+    operator>=(const multistep_iterator<Iter, Sentinel, Stride> &lhs, const multistep_iterator<Iter, Sentinel, Stride> &rhs)
     {
         return !(lhs < rhs);
     }
 
-    template <typename Iter>
-    inline constexpr auto make_step_iterator(Iter iter, std::size_t step, Iter end = Iter())
+    template <typename Iter, typename Sentinel, std::size_t Stride, typename BaseSentinel>
+    inline constexpr bool
+    operator==(const multistep_iterator<Iter, Sentinel, Stride> &lhs, const adaptor_sentinel<BaseSentinel> &rhs)
+    {
+        return lhs.base() == rhs.base();
+    }
+
+    template <typename Iter, typename Sentinel, std::size_t Stride, typename BaseSentinel>
+    inline constexpr bool
+    operator==(const adaptor_sentinel<BaseSentinel> &lhs, const multistep_iterator<Iter, Sentinel, Stride> &rhs)
+    {
+        return rhs == lhs;
+    }
+
+    template <typename Iter, typename Sentinel, std::size_t Stride, typename BaseSentinel>
+    inline constexpr bool
+    operator!=(const multistep_iterator<Iter, Sentinel, Stride> &lhs, const adaptor_sentinel<BaseSentinel> &rhs)
     {
-        return multistep_iterator<Iter>(iter, step, end);
+        return !(lhs == rhs);
     }
 
+    template <typename Iter, typename Sentinel, std::size_t Stride, typename BaseSentinel>
+    inline constexpr bool
+    operator!=(const adaptor_sentinel<BaseSentinel> &lhs, const multistep_iterator<Iter, Sentinel, Stride> &rhs)
+    {
+        return !(rhs == lhs);
+    }
+
+    namespace details
+    {
+        template <typename Iter, typename Sentinel, std::size_t Stride>
+        struct sentinel_traits<multistep_iterator<Iter, Sentinel, Stride>> :
+            adaptor_sentinel_traits<multistep_iterator<Iter, Sentinel, Stride>>
+        {
+        };
+
+        template <typename Iter, typename Sentinel, std::size_t Stride>
+        struct is_sized_iterator<multistep_iterator<Iter, Sentinel, Stride>> :
+            std::bool_constant<is_sized_iterator_v<Iter> && is_common_v<Iter, Sentinel>>
+        {
+        };
+
+        /*
+        ** Random access bases are indexed with the stride directly. Others are walked entirely,
+        ** like when pulling, pushing every step-th element.
+        */
+        template <typename Iter, typename Sentinel, std::size_t Stride>
+        struct push_traversal<multistep_iterator<Iter, Sentinel, Stride>>
+        {
+            static constexpr bool value = true;
+
+            template <typename Last, typename Sink>
+            static constexpr bool run(const multistep_iterator<Iter, Sentinel, Stride> &first, const Last &last, Sink &sink)
+            {
+                using difference_type = typename multistep_iterator<Iter, Sentinel, Stride>::difference_type;
+                auto stride = static_cast<difference_type>(first.step());
+
+                if constexpr (is_sized_v<Iter, std::decay_t<decltype(last.base())>> && is_common_v<Iter, Sentinel>) {
+                    auto [base, stop] = unwrap_contiguous(first.base(), last.base());
+                    auto n = stop - base;
+
+                    for (difference_type i = 0; i < n; i += stride) {
+                        if (sink(base[i])) {
+                            return true;
+                        }
+                    }
+                    return false;
+                } else {
+                    difference_type skip = 0;
+
+                    return for_each_until(first.base(), last.base(), [&skip, stride, &sink](auto &&value) {
+                        if (skip != 0) {
+                            --skip;
+                            return false;
+                        }
+                        skip = stride - 1;
+                        return static_cast<bool>(sink(std::forward<decltype(value)>(value)));
+                    });
+                }
+            }
+        };
+    }
+
+    template <std::size_t Stride = 0, typename Iter, typename Sentinel = Iter>
+    inline constexpr auto make_step_iterator(Iter iter, std::size_t step, Sentinel end = Sentinel(),
+                                             typename std::iterator_traits<Iter>::difference_type missing = 0)
+    {
+        return multistep_iterator<Iter, Sentinel, Stride>(iter, step, end, missing);
+    }
+
+    namespace details
+    {
+        template <std::size_t Stride, typename Container>
+        inline constexpr auto make_step_range(Container &&container, std::size_t step)
+        {
+            auto first = std::begin(std::forward<Container>(container));
+            auto last = std::end(std::forward<Container>(container));
+            if constexpr (is_common_v<decltype(first), decltype(last)> && has_constant_jumps_v<decltype(first)>) {
+                auto stride = static_cast<decltype(last - first)>(step);
+                auto missing = (stride - (last - first) % stride) % stride;
+
+                return make_range(make_step_iterator<Stride>(first, step, last),
+                                  make_step_iterator<Stride>(last, step, last, missing));
+            } else if constexpr (is_common_v<decltype(first), decltype(last)>) {
+                auto stop = make_sentinel(last);
+
+                return make_range(make_step_iterator<Stride>(first, step, stop),
+                                  make_step_iterator<Stride>(last, step, stop));
+            } else {
+                auto stop = make_sentinel(last);
+
+                return make_range(make_step_iterator<Stride>(first, step, stop), adaptor_sentinel<decltype(stop)>(stop));
+            }
+        }
+    }
+
+    /*
+    ** Takes every step-th element of container, starting with the first one. step must be
+    ** positive.
+    */
     template <typename Container>
     inline constexpr auto step(Container &&container, std::size_t step)
     {
-        return make_range(
-            make_step_iterator(std::begin(std::forward<Container>(container)), step,
-                               std::end(std::forward<Container>(container))),
-            make_step_iterator(std::end(std::forward<Container>(container)), step,
-                               std::end(std::forward<Container>(container)))
-        );
+        assert(step > 0 && "step needs a positive stride");
+        return details::make_step_range<0>(std::forward<Container>(container), step);
+    }
+
+    /*
+    ** Takes every Stride-th element, with the stride in the type of the iterators, which lets the
+    ** compiler unroll and vectorize strided accesses, like when deinterleaving channels.
+    */
+    template <std::size_t Stride, typename Container>
+    inline constexpr auto step(Container &&container)
+    {
+        static_assert(Stride != 0, "step<0> would never move forward");
+        return details::make_step_range<Stride>(std::forward<Container>(container), Stride);
     }
 
     namespace details
@@ -222,12 +498,79 @@ namespace smite
 
             std::size_t _step;
         };
+
+        template <std::size_t Stride>
+        struct static_step_maker
+        {
+            using smite_tag = range_maker_tag;
+
+            template <typename Range>
+            constexpr auto operator()(Range &&rng) const
+            {
+                return step<Stride>(std::forward<Range>(rng));
+            }
+        };
     }
 
     inline constexpr auto make_step(std::size_t step)
     {
+        assert(step > 0 && "step needs a positive stride");
         return details::step_maker{step};
     }
+
+    template <std::size_t Stride>
+    inline constexpr auto make_step()
+    {
+        return details::static_step_maker<Stride>{};
+    }
+
+    namespace details
+    {
+        template <typename Transformer>
+        struct transform_maker;
+
+        /*
+        ** Taking every b-th element of every a-th element is taking every (a * b)-th element.
+        */
+        inline constexpr auto fuse(const step_maker &first, const step_maker &second)
+        {
+            return step_maker{first._step * second._step};
+        }
+
+        template <std::size_t First, std::size_t Second>
+        inline constexpr auto fuse(const static_step_maker<First> &, const static_step_maker<Second> &)
+        {
+            return static_step_maker<First * Second>{};
+        }
+
+        template <std::size_t Stride>
+        inline constexpr auto fuse(const step_maker &first, const static_step_maker<Stride> &)
+        {
+            return step_maker{first._step * Stride};
+        }
+
+        template <std::size_t Stride>
+        inline constexpr auto fuse(const static_step_maker<Stride> &, const step_maker &second)
+        {
+            return step_maker{Stride * second._step};
+        }
+
+        /*
+        ** Striding before transforming lets the stride work on the bare base iterators, and lets
+        ** the transform fuse with whatever follows it.
+        */
+        template <typename Transformer>
+        inline constexpr auto fuse(const transform_maker<Transformer> &first, const step_maker &second)
+        {
+            return composed_maker<step_maker, transform_maker<Transformer>>(second, first);
+        }
+
+        template <typename Transformer, std::size_t Stride>
+        inline constexpr auto fuse(const transform_maker<Transformer> &first, const static_step_maker<Stride> &second)
+        {
+            return composed_maker<static_step_maker<Stride>, transform_maker<Transformer>>(second, first);
+        }
+    }
 }
 
 #endif /* !SMITE_MULTISTEP_ITERATOR_HPP */
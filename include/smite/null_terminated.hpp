@@ -0,0 +1,47 @@
+/*
+** Created by doom on 18/10/26.
+*/
+
+#ifndef SMITE_NULL_TERMINATED_HPP
+#define SMITE_NULL_TERMINATED_HPP
+
+#include <smite/range.hpp>
+
+namespace smite
+{
+    struct null_sentinel
+    {
+    };
+
+    template <typename T>
+    inline constexpr bool operator==(T *ptr, null_sentinel) noexcept
+    {
+        return *ptr == T();
+    }
+
+    template <typename T>
+    inline constexpr bool operator==(null_sentinel, T *ptr) noexcept
+    {
+        return *ptr == T();
+    }
+
+    template <typename T>
+    inline constexpr bool operator!=(T *ptr, null_sentinel) noexcept
+    {
+        return !(*ptr == T());
+    }
+
+    template <typename T>
+    inline constexpr bool operator!=(null_sentinel, T *ptr) noexcept
+    {
+        return !(*ptr == T());
+    }
+
+    template <typename T>
+    inline constexpr auto null_terminated(T *ptr)
+    {
+        return make_range(ptr, null_sentinel{});
+    }
+}
+
+#endif /* !SMITE_NULL_TERMINATED_HPP */
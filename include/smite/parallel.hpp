@@ -0,0 +1,287 @@
+/*
+** Created by doom on 18/10/26.
+*/
+
+#ifndef SMITE_PARALLEL_HPP
+#define SMITE_PARALLEL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <smite/range.hpp>
+#include <smite/reduce.hpp>
+#include <smite/collect.hpp>
+#include <smite/for_each.hpp>
+#include <smite/details/thread_pool.hpp>
+
+namespace smite::par
+{
+    using thread_pool = details::thread_pool;
+
+    struct options
+    {
+        /*
+        ** Number of elements handed to a task at once, 0 to pick one.
+        */
+        std::size_t grain = 0;
+
+        /*
+        ** Makes the chunks depend on the size of the range only, and not on the number of threads,
+        ** so that floating point reductions give the same result on every machine and every run.
+        */
+        bool deterministic = false;
+
+        thread_pool *pool = nullptr;
+    };
+
+    namespace details
+    {
+        inline constexpr std::size_t deterministic_grain = 1u << 14;
+        inline constexpr std::size_t chunks_per_thread = 4;
+
+        /*
+        ** Below that many elements per task, scheduling costs more than the work it spreads.
+        */
+        inline constexpr std::size_t min_grain = 1u << 12;
+
+        /*
+        ** Ranges are split with operator+, which needs random access iterators that can jump in
+        ** constant time and a common end.
+        */
+        template <typename Range>
+        inline constexpr bool is_splittable_v = smite::details::is_common_v<
+            decltype(std::begin(std::declval<Range &>())),
+            decltype(std::end(std::declval<Range &>()))
+        > && smite::details::has_constant_jumps_v<decltype(std::begin(std::declval<Range &>()))>;
+
+        /*
+        ** Filters cannot be split, but the ranges they filter can, when they are splittable.
+        */
+        template <typename Iter, typename Sentinel, typename = void>
+        struct is_compactable : std::false_type
+        {
+        };
+
+        template <typename Iter>
+        struct is_compactable<Iter, Iter, std::enable_if_t<smite::details::is_filter_iterator<Iter>::value>> :
+            std::bool_constant<smite::details::has_constant_jumps_v<typename Iter::iterator_type>>
+        {
+        };
+
+        template <typename Container, typename = void>
+        struct is_scatterable : std::false_type
+        {
+        };
+
+        template <typename Container>
+        struct is_scatterable<Container, std::void_t<decltype(std::declval<Container &>().resize(std::size_t{}))>> :
+            std::bool_constant<std::is_base_of_v<
+                std::random_access_iterator_tag,
+                typename std::iterator_traits<decltype(std::begin(std::declval<Container &>()))>::iterator_category
+            >>
+        {
+        };
+
+        inline std::size_t grain_for(std::size_t size, const options &opts, const thread_pool &pool)
+        {
+            if (opts.grain != 0) {
+                return opts.grain;
+            }
+            if (opts.deterministic) {
+                return deterministic_grain;
+            }
+            return std::max(size / (pool.size() * chunks_per_thread), min_grain);
+        }
+
+        inline thread_pool &pool_of(const options &opts)
+        {
+            return opts.pool != nullptr ? *opts.pool : thread_pool::global();
+        }
+
+        /*
+        ** Calls f(chunk_first, chunk_last, chunk_index) for each chunk of [first, last), on the pool.
+        */
+        template <typename Iter, typename Function>
+        void for_each_chunk(Iter first, Iter last, const options &opts, std::size_t chunks, std::size_t grain,
+                            Function &&f)
+        {
+            pool_of(opts).run_batch(chunks, [&](std::size_t chunk) {
+                using difference_type = typename std::iterator_traits<decltype(first)>::difference_type;
+                auto begin = static_cast<difference_type>(chunk * grain);
+                auto chunk_first = first + begin;
+                auto chunk_last = (chunk + 1 == chunks) ? last : chunk_first + static_cast<difference_type>(grain);
+
+                f(chunk_first, chunk_last, chunk);
+            });
+        }
+
+        inline std::size_t chunk_count(std::size_t size, std::size_t grain)
+        {
+            return (size + grain - 1) / grain;
+        }
+
+        /*
+        ** Stream compaction: every chunk counts its matches, a prefix sum over the counts gives each
+        ** chunk its offset in the output, and every chunk then writes its matches at that offset.
+        ** The chunks write to disjoint slices of the output, which needs no synchronization. The
+        ** predicate is evaluated twice per element, instead of storing the results, which would
+        ** cost another pass over memory.
+        */
+        template <typename Container, typename Range>
+        Container compact(Range &rng, const options &opts)
+        {
+            auto filtered = std::begin(rng);
+            const auto &pred = filtered.predicate();
+            auto first = filtered.base();
+            auto last = std::end(rng).base();
+            auto size = static_cast<std::size_t>(last - first);
+            auto grain = grain_for(size, opts, pool_of(opts));
+            auto chunks = chunk_count(size, grain);
+
+            if (chunks <= 1) {
+                return smite::details::collect<Container>(rng);
+            }
+            Container out;
+            std::vector<std::size_t> offsets(chunks + 1, 0);
+
+            for_each_chunk(first, last, opts, chunks, grain, [&](auto chunk_first, auto chunk_last, std::size_t chunk) {
+                auto matches = smite::count_if(make_range(chunk_first, chunk_last), pred);
+
+                offsets[chunk + 1] = static_cast<std::size_t>(matches);
+            });
+            for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+                offsets[chunk + 1] += offsets[chunk];
+            }
+            out.resize(offsets[chunks]);
+
+            auto out_first = std::begin(out);
+
+            for_each_chunk(first, last, opts, chunks, grain, [&](auto chunk_first, auto chunk_last, std::size_t chunk) {
+                using difference_type = typename std::iterator_traits<decltype(out_first)>::difference_type;
+                auto dest = out_first + static_cast<difference_type>(offsets[chunk]);
+
+                for (; chunk_first != chunk_last; ++chunk_first) {
+                    decltype(auto) value = *chunk_first;
+
+                    if (pred(value)) {
+                        *dest = std::forward<decltype(value)>(value);
+                        ++dest;
+                    }
+                }
+            });
+            return out;
+        }
+    }
+
+    /*
+    ** Calls f on every element of rng, from several threads. Ranges that cannot be split are walked
+    ** on the calling thread.
+    */
+    template <typename Range, typename Function>
+    void for_each(Range &&rng, Function f, const options &opts = {})
+    {
+        if constexpr (details::is_splittable_v<Range>) {
+            auto size = static_cast<std::size_t>(std::end(rng) - std::begin(rng));
+
+            if (size == 0) {
+                return;
+            }
+            auto &pool = details::pool_of(opts);
+            auto grain = details::grain_for(size, opts, pool);
+
+            details::for_each_chunk(std::begin(rng), std::end(rng), opts, details::chunk_count(size, grain), grain,
+                                    [&f](auto first, auto last, std::size_t) {
+                                        for (; first != last; ++first) {
+                                            f(*first);
+                                        }
+                                    });
+        } else {
+            smite::for_each(rng, f);
+        }
+    }
+
+    /*
+    ** Folds rng into init with op from several threads. Each chunk is folded starting from its first
+    ** element, and the partial results are then folded into init in the order of the chunks, so op
+    ** must be associative and commutative, and T constructible from the elements.
+    */
+    template <typename Range, typename T, typename BinaryOp>
+    T reduce(Range &&rng, T init, BinaryOp op, const options &opts = {})
+    {
+        if constexpr (details::is_splittable_v<Range>) {
+            auto size = static_cast<std::size_t>(std::end(rng) - std::begin(rng));
+
+            if (size == 0) {
+                return init;
+            }
+            auto &pool = details::pool_of(opts);
+            auto grain = details::grain_for(size, opts, pool);
+            auto chunks = details::chunk_count(size, grain);
+            std::vector<std::optional<T>> partials(chunks);
+
+            details::for_each_chunk(std::begin(rng), std::end(rng), opts, chunks, grain,
+                                    [&](auto first, auto last, std::size_t chunk) {
+                                        T partial = *first;
+
+                                        partials[chunk].emplace(
+                                            smite::reduce(make_range(++first, last), std::move(partial), op)
+                                        );
+                                    });
+            for (auto &partial : partials) {
+                init = op(std::move(init), std::move(*partial));
+            }
+            return init;
+        } else {
+            return smite::reduce(std::forward<Range>(rng), std::move(init), op);
+        }
+    }
+
+    /*
+    ** Materializes a range into a Container. Filters over splittable ranges are compacted from
+    ** several threads into a Container that can be resized and indexed, like std::vector, keeping
+    ** the order of the elements. Everything else is collected on the calling thread.
+    */
+    template <typename Container, typename Range>
+    Container collect(Range &&rng, const options &opts = {})
+    {
+        using iterator = decltype(std::begin(rng));
+        using sentinel = decltype(std::end(rng));
+
+        if constexpr (details::is_compactable<iterator, sentinel>::value &&
+                      details::is_scatterable<Container>::value &&
+                      std::is_default_constructible_v<typename Container::value_type>) {
+            return details::compact<Container>(rng, opts);
+        } else {
+            return smite::details::collect<Container>(std::forward<Range>(rng));
+        }
+    }
+
+    namespace details
+    {
+        template <typename Container>
+        struct to_maker
+        {
+            using smite_tag = range_maker_tag;
+
+            template <typename Range>
+            Container operator()(Range &&rng) const
+            {
+                return par::collect<Container>(std::forward<Range>(rng), _opts);
+            }
+
+            options _opts;
+        };
+    }
+
+    template <typename Container>
+    inline auto to(const options &opts = {})
+    {
+        return details::to_maker<Container>{opts};
+    }
+}
+
+#endif /* !SMITE_PARALLEL_HPP */
@@ -0,0 +1,325 @@
+/*
+** Created by doom on 18/10/26.
+*/
+
+#ifndef SMITE_PREFETCH_ITERATOR_HPP
+#define SMITE_PREFETCH_ITERATOR_HPP
+
+#include <cstddef>
+#include <utility>
+#include <iterator>
+#include <type_traits>
+#include <smite/range.hpp>
+#include <smite/details/push.hpp>
+#include <smite/details/compressed_pair.hpp>
+
+namespace smite
+{
+    namespace details
+    {
+        /*
+        ** Asks for the cache line holding address to be loaded, without waiting for it.
+        */
+        inline void prefetch_address(const void *address) noexcept
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            __builtin_prefetch(address, 0, 3);
+#else
+            (void)address;
+#endif
+        }
+
+        template <std::size_t Distance>
+        struct prefetch_distance_storage
+        {
+            constexpr explicit prefetch_distance_storage(std::size_t) noexcept
+            {
+            }
+
+            static constexpr std::size_t distance() noexcept
+            {
+                return Distance;
+            }
+        };
+
+        template <>
+        struct prefetch_distance_storage<0>
+        {
+            constexpr explicit prefetch_distance_storage(std::size_t distance) noexcept : _distance(distance)
+            {
+            }
+
+            constexpr std::size_t distance() const noexcept
+            {
+                return _distance;
+            }
+
+            std::size_t _distance;
+        };
+    }
+
+    /*
+    ** Yields the elements of its base unchanged, and meanwhile prefetches the address that
+    ** address_fn gives for the element Distance positions ahead, so that the memory an element
+    ** leads to, like the row of a table an index points to, is already on its way when the
+    ** element is reached. A Distance of 0 means that the distance is given at runtime.
+    */
+    template <typename Iter, typename AddressFn, typename Sentinel = Iter, std::size_t Distance = 0>
+    class prefetch_iterator :
+        private details::compressed_pair<Iter, AddressFn>,
+        private details::prefetch_distance_storage<Distance>
+    {
+    public:
+        using iterator_type = Iter;
+        using sentinel_type = Sentinel;
+        using address_fn_type = AddressFn;
+
+    private:
+        using base_type = details::compressed_pair<Iter, AddressFn>;
+        using distance_base = details::prefetch_distance_storage<Distance>;
+        using iterator_traits = std::iterator_traits<Iter>;
+
+        static_assert(std::is_base_of_v<std::forward_iterator_tag, typename iterator_traits::iterator_category>,
+                      "prefetching reads ahead, which needs a forward range");
+
+    public:
+        using difference_type = typename iterator_traits::difference_type;
+        using value_type = typename iterator_traits::value_type;
+        using reference = typename iterator_traits::reference;
+        using pointer = typename iterator_traits::pointer;
+        using iterator_category = std::forward_iterator_tag;
+
+        constexpr prefetch_iterator(Iter iter, AddressFn address_fn, std::size_t distance, Sentinel end = Sentinel()) :
+            base_type(iter, std::move(address_fn)), distance_base(distance), _ahead(iter), _end(end)
+        {
+            for (std::size_t i = 0; i < this->distance() && _ahead != _end; ++i) {
+                _prefetch_ahead();
+            }
+        }
+
+        constexpr prefetch_iterator(const prefetch_iterator &) = default;
+
+        constexpr prefetch_iterator(prefetch_iterator &&) = default;
+
+        constexpr prefetch_iterator &operator=(const prefetch_iterator &) = default;
+
+        constexpr prefetch_iterator &operator=(prefetch_iterator &&) = default;
+
+        constexpr reference operator*() const
+        {
+            return *base();
+        }
+
+        constexpr pointer operator->() const
+        {
+            if constexpr (std::is_pointer_v<Iter>) {
+                return base();
+            } else {
+                return base().operator->();
+            }
+        }
+
+        constexpr prefetch_iterator &operator++()
+        {
+            ++base();
+            if (_ahead != _end) {
+                _prefetch_ahead();
+            }
+            return *this;
+        }
+
+        constexpr const prefetch_iterator operator++(int)
+        {
+            auto tmp = *this;
+
+            ++*this;
+            return tmp;
+        }
+
+        constexpr iterator_type &base() noexcept
+        {
+            return base_type::first();
+        }
+
+        constexpr const iterator_type &base() const noexcept
+        {
+            return base_type::first();
+        }
+
+        constexpr const address_fn_type &address_fn() const noexcept
+        {
+            return base_type::second();
+        }
+
+        constexpr const iterator_type &ahead() const noexcept
+        {
+            return _ahead;
+        }
+
+        constexpr const sentinel_type &sentinel() const noexcept
+        {
+            return _end;
+        }
+
+        using distance_base::distance;
+
+    private:
+        constexpr void _prefetch_ahead()
+        {
+            details::prefetch_address(static_cast<const void *>(address_fn()(*_ahead)));
+            ++_ahead;
+        }
+
+        Iter _ahead;
+        Sentinel _end;
+    };
+
+    template <typename Iter, typename AddressFn, typename Sentinel, std::size_t Distance>
+    inline constexpr bool operator==(const prefetch_iterator<Iter, AddressFn, Sentinel, Distance> &lhs,
+                                     const prefetch_iterator<Iter, AddressFn, Sentinel, Distance> &rhs)
+    {
+        return lhs.base() == rhs.base();
+    }
+
+    template <typename Iter, typename AddressFn, typename Sentinel, std::size_t Distance>
+    inline constexpr bool operator!=(const prefetch_iterator<Iter, AddressFn, Sentinel, Distance> &lhs,
+                                     const prefetch_iterator<Iter, AddressFn, Sentinel, Distance> &rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+    template <typename Iter, typename AddressFn, typename Sentinel, std::size_t Distance, typename BaseSentinel>
+    inline constexpr bool operator==(const prefetch_iterator<Iter, AddressFn, Sentinel, Distance> &lhs,
+                                     const adaptor_sentinel<BaseSentinel> &rhs)
+    {
+        return lhs.base() == rhs.base();
+    }
+
+    template <typename Iter, typename AddressFn, typename Sentinel, std::size_t Distance, typename BaseSentinel>
+    inline constexpr bool operator==(const adaptor_sentinel<BaseSentinel> &lhs,
+                                     const prefetch_iterator<Iter, AddressFn, Sentinel, Distance> &rhs)
+    {
+        return rhs == lhs;
+    }
+
+    template <typename Iter, typename AddressFn, typename Sentinel, std::size_t Distance, typename BaseSentinel>
+    inline constexpr bool operator!=(const prefetch_iterator<Iter, AddressFn, Sentinel, Distance> &lhs,
+                                     const adaptor_sentinel<BaseSentinel> &rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+    template <typename Iter, typename AddressFn, typename Sentinel, std::size_t Distance, typename BaseSentinel>
+    inline constexpr bool operator!=(const adaptor_sentinel<BaseSentinel> &lhs,
+                                     const prefetch_iterator<Iter, AddressFn, Sentinel, Distance> &rhs)
+    {
+        return !(rhs == lhs);
+    }
+
+    namespace details
+    {
+        template <typename Iter, typename AddressFn, typename Sentinel, std::size_t Distance>
+        struct sentinel_traits<prefetch_iterator<Iter, AddressFn, Sentinel, Distance>> :
+            adaptor_sentinel_traits<prefetch_iterator<Iter, AddressFn, Sentinel, Distance>>
+        {
+        };
+
+        /*
+        ** The elements are pushed from a loop over the base, and the iterator ahead follows along.
+        */
+        template <typename Iter, typename AddressFn, typename Sentinel, std::size_t Distance>
+        struct push_traversal<prefetch_iterator<Iter, AddressFn, Sentinel, Distance>>
+        {
+            static constexpr bool value = true;
+
+            template <typename Last, typename Sink>
+            static constexpr bool run(const prefetch_iterator<Iter, AddressFn, Sentinel, Distance> &first,
+                                      const Last &last, Sink &sink)
+            {
+                const auto &address_fn = first.address_fn();
+                const auto &end = first.sentinel();
+                auto ahead = first.ahead();
+
+                return for_each_until(first.base(), last.base(), [&](auto &&value) {
+                    if (ahead != end) {
+                        prefetch_address(static_cast<const void *>(address_fn(*ahead)));
+                        ++ahead;
+                    }
+                    return sink(std::forward<decltype(value)>(value));
+                });
+            }
+        };
+
+        template <std::size_t Distance, typename Container, typename AddressFn>
+        inline constexpr auto make_prefetch_range(Container &&container, AddressFn &&address_fn, std::size_t distance)
+        {
+            auto first = std::begin(std::forward<Container>(container));
+            auto last = std::end(std::forward<Container>(container));
+            auto stop = make_sentinel(last);
+            using iterator = prefetch_iterator<decltype(first), std::decay_t<AddressFn>, decltype(stop), Distance>;
+
+            if constexpr (is_common_v<decltype(first), decltype(last)>) {
+                return make_range(iterator(first, address_fn, distance, stop), iterator(last, address_fn, distance, stop));
+            } else {
+                return make_range(iterator(first, address_fn, distance, stop), adaptor_sentinel<decltype(stop)>(stop));
+            }
+        }
+    }
+
+    /*
+    ** Prefetches address_fn(element) distance elements ahead of the one being consumed. The right
+    ** distance covers the latency of a miss with the work done per element: too short and the
+    ** data arrives late, too long and it gets evicted before use.
+    */
+    template <typename Container, typename AddressFn>
+    inline constexpr auto prefetch(Container &&container, AddressFn &&address_fn, std::size_t distance)
+    {
+        return details::make_prefetch_range<0>(std::forward<Container>(container),
+                                               std::forward<AddressFn>(address_fn), distance);
+    }
+
+    template <std::size_t Distance, typename Container, typename AddressFn>
+    inline constexpr auto prefetch(Container &&container, AddressFn &&address_fn)
+    {
+        static_assert(Distance != 0, "a prefetch distance of 0 prefetches nothing");
+        return details::make_prefetch_range<Distance>(std::forward<Container>(container),
+                                                      std::forward<AddressFn>(address_fn), Distance);
+    }
+
+    namespace details
+    {
+        template <typename AddressFn, std::size_t Distance>
+        struct prefetch_maker : private prefetch_distance_storage<Distance>
+        {
+            using smite_tag = range_maker_tag;
+
+            constexpr prefetch_maker(AddressFn address_fn, std::size_t distance) :
+                prefetch_distance_storage<Distance>(distance), _address_fn(std::move(address_fn))
+            {
+            }
+
+            template <typename Range>
+            constexpr auto operator()(Range &&rng) const
+            {
+                return make_prefetch_range<Distance>(std::forward<Range>(rng), _address_fn, this->distance());
+            }
+
+            AddressFn _address_fn;
+        };
+    }
+
+    template <typename AddressFn>
+    inline constexpr auto make_prefetch(AddressFn &&address_fn, std::size_t distance)
+    {
+        return details::prefetch_maker<std::decay_t<AddressFn>, 0>(std::forward<AddressFn>(address_fn), distance);
+    }
+
+    template <std::size_t Distance, typename AddressFn>
+    inline constexpr auto make_prefetch(AddressFn &&address_fn)
+    {
+        static_assert(Distance != 0, "a prefetch distance of 0 prefetches nothing");
+        return details::prefetch_maker<std::decay_t<AddressFn>, Distance>(std::forward<AddressFn>(address_fn), Distance);
+    }
+}
+
+#endif /* !SMITE_PREFETCH_ITERATOR_HPP */
@@ -5,17 +5,68 @@
 #ifndef SMITE_RANGE_HPP
 #define SMITE_RANGE_HPP
 
+#include <cstddef>
 #include <utility>
+#include <iterator>
+#include <type_traits>
+#include <smite/details/storage.hpp>
+#include <smite/details/compressed_pair.hpp>
 
 namespace smite
 {
-    template <typename Iter>
+    namespace details
+    {
+        /*
+        ** Whether the distance between two iterators of that type is computed in constant time.
+        ** Adaptors forward it from their bases, and the ones which have to walk say no.
+        */
+        template <typename Iter, typename = void>
+        struct is_sized_iterator : std::false_type
+        {
+        };
+
+        template <typename Iter>
+        struct is_sized_iterator<Iter, std::void_t<typename std::iterator_traits<Iter>::iterator_category>> :
+            std::is_base_of<std::random_access_iterator_tag, typename std::iterator_traits<Iter>::iterator_category>
+        {
+        };
+
+        template <typename Iter>
+        inline constexpr bool is_sized_iterator_v = is_sized_iterator<Iter>::value;
+
+        template <typename Iter, typename Sentinel, typename = void>
+        struct is_sized : std::false_type
+        {
+        };
+
+        template <typename Iter, typename Sentinel>
+        struct is_sized<Iter, Sentinel, std::void_t<decltype(std::declval<const Sentinel &>() - std::declval<const Iter &>())>> :
+            is_sized_iterator<Iter>
+        {
+        };
+
+        template <typename Iter, typename Sentinel>
+        inline constexpr bool is_sized_v = is_sized<Iter, Sentinel>::value;
+
+        /*
+        ** Whether the iterator moves by any distance in constant time. Adaptors like filter keep the
+        ** random-access category of their base while walking it, so the category is not enough.
+        */
+        template <typename Iter>
+        inline constexpr bool has_constant_jumps_v = is_sized_iterator_v<Iter> && std::is_base_of_v<
+            std::random_access_iterator_tag,
+            typename std::iterator_traits<Iter>::iterator_category
+        >;
+    }
+
+    template <typename Iter, typename Sentinel = Iter>
     class range
     {
     public:
         using iterator = Iter;
+        using sentinel = Sentinel;
 
-        constexpr range(iterator b, iterator e) : _begin(b), _end(e)
+        constexpr range(iterator b, sentinel e) : _begin(b), _end(e)
         {
         }
 
@@ -32,20 +83,90 @@ namespace smite
             return _begin;
         }
 
-        constexpr iterator end() const
+        constexpr sentinel end() const
         {
             return _end;
         }
 
+        template <typename I = Iter, std::enable_if_t<details::is_sized_v<I, Sentinel>, int> = 0>
+        constexpr std::size_t size() const
+        {
+            return static_cast<std::size_t>(_end - _begin);
+        }
+
     private:
         iterator _begin;
-        iterator _end;
+        sentinel _end;
     };
 
-    template <typename Iter>
-    inline constexpr range<Iter> make_range(Iter begin, Iter end)
+    template <typename Iter, typename Sentinel>
+    inline constexpr range<Iter, Sentinel> make_range(Iter begin, Sentinel end)
     {
-        return range<Iter>{begin, end};
+        return range<Iter, Sentinel>{begin, end};
+    }
+
+    template <typename Sentinel>
+    class adaptor_sentinel : private details::storage<Sentinel, struct adaptor_sentinel_base>
+    {
+    private:
+        using base_type = details::storage<Sentinel, struct adaptor_sentinel_base>;
+
+    public:
+        using sentinel_type = Sentinel;
+
+        constexpr explicit adaptor_sentinel(Sentinel sentinel) : base_type(std::move(sentinel))
+        {
+        }
+
+        constexpr adaptor_sentinel(const adaptor_sentinel &) = default;
+
+        constexpr adaptor_sentinel(adaptor_sentinel &&) = default;
+
+        constexpr adaptor_sentinel &operator=(const adaptor_sentinel &) = default;
+
+        constexpr adaptor_sentinel &operator=(adaptor_sentinel &&) = default;
+
+        constexpr const sentinel_type &base() const noexcept
+        {
+            return base_type::get();
+        }
+    };
+
+    namespace details
+    {
+        template <typename Iter, typename Sentinel>
+        inline constexpr bool is_common_v = std::is_same_v<Iter, Sentinel>;
+
+        template <typename T>
+        struct sentinel_traits
+        {
+            using type = T;
+
+            static constexpr const type &make(const T &t) noexcept
+            {
+                return t;
+            }
+        };
+
+        template <typename T>
+        using sentinel_t = typename sentinel_traits<T>::type;
+
+        template <typename T>
+        inline constexpr sentinel_t<T> make_sentinel(const T &t)
+        {
+            return sentinel_traits<T>::make(t);
+        }
+
+        template <typename Iter>
+        struct adaptor_sentinel_traits
+        {
+            using type = adaptor_sentinel<sentinel_t<typename Iter::iterator_type>>;
+
+            static constexpr type make(const Iter &it)
+            {
+                return type(make_sentinel(it.base()));
+            }
+        };
     }
 
     struct range_maker_tag
@@ -106,13 +227,94 @@ namespace smite
         Func _f;
     };
 
+    namespace details
+    {
+        template <typename First, typename Second>
+        struct composed_maker : private compressed_pair<First, Second>
+        {
+        private:
+            using base_type = compressed_pair<First, Second>;
+
+        public:
+            using smite_tag = range_maker_tag;
+            using first_maker_type = First;
+            using second_maker_type = Second;
+
+            constexpr composed_maker(First first, Second second) : base_type(std::move(first), std::move(second))
+            {
+            }
+
+            template <typename ...Args>
+            constexpr auto operator()(Args &&...args) const
+            {
+                return second()(first()(std::forward<Args>(args)...));
+            }
+
+            constexpr const First &first() const noexcept
+            {
+                return base_type::first();
+            }
+
+            constexpr const Second &second() const noexcept
+            {
+                return base_type::second();
+            }
+        };
+
+        template <typename T>
+        struct is_composed_maker : std::false_type
+        {
+        };
+
+        template <typename First, typename Second>
+        struct is_composed_maker<composed_maker<First, Second>> : std::true_type
+        {
+        };
+
+        template <typename T>
+        inline constexpr bool is_composed_maker_v = is_composed_maker<T>::value;
+
+        /*
+        ** Adaptors can declare a fuse(m1, m2) overload next to their makers, found by ADL, returning
+        ** a single maker equivalent to m1 followed by m2.
+        */
+        template <typename M1, typename M2, typename = void>
+        struct is_fusable : std::false_type
+        {
+        };
+
+        template <typename M1, typename M2>
+        struct is_fusable<M1, M2, std::void_t<decltype(fuse(std::declval<const M1 &>(), std::declval<const M2 &>()))>> :
+            std::true_type
+        {
+        };
+
+        template <typename M1, typename M2>
+        inline constexpr bool is_fusable_v = is_fusable<M1, M2>::value;
+
+        template <typename M1, typename M2>
+        inline constexpr bool is_fusable_before_v = false;
+
+        template <typename M1, typename First, typename Second>
+        inline constexpr bool is_fusable_before_v<M1, composed_maker<First, Second>> = is_fusable_v<M1, First>;
+    }
+
+    /*
+    ** Compositions are kept right-nested, so that appending a maker gives every adjacent pair a chance
+    ** to fuse.
+    */
     template <typename M1, typename M2, std::enable_if_t<is_range_maker_v<M1> && is_range_maker_v<M2>, int> = 0>
     inline constexpr auto operator|(const M1 &m1, const M2 &m2)
     {
-        auto f = [m1, m2](auto &&...params) {
-            return m2(m1(params...));
-        };
-        return range_maker<decltype(f)>{std::move(f)};
+        if constexpr (details::is_composed_maker_v<M1>) {
+            return m1.first() | (m1.second() | m2);
+        } else if constexpr (details::is_fusable_v<M1, M2>) {
+            return fuse(m1, m2);
+        } else if constexpr (details::is_fusable_before_v<M1, M2>) {
+            return fuse(m1, m2.first()) | m2.second();
+        } else {
+            return details::composed_maker<M1, M2>(m1, m2);
+        }
     }
 
     template <typename R, typename M, std::enable_if_t<is_range_v<R> && is_range_maker_v<M>, int> = 0>
@@ -0,0 +1,517 @@
+/*
+** Created by doom on 18/10/26.
+*/
+
+#ifndef SMITE_READ_BLOCKS_HPP
+#define SMITE_READ_BLOCKS_HPP
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <smite/range.hpp>
+#include <smite/details/fake_ptr.hpp>
+#include <smite/details/io_ring.hpp>
+
+namespace smite
+{
+    struct block_options
+    {
+        /*
+        ** Number of buffers in the pool. One is held by the consumer, the others are filled ahead.
+        */
+        std::size_t buffers = 4;
+
+        /*
+        ** Drops the blocks of regular files from the page cache once read, so that a scan over a
+        ** file larger than memory does not evict everything else.
+        */
+        bool drop_cache = false;
+
+        /*
+        ** Reads seekable descriptors through io_uring where the kernel allows it. When disabled, or
+        ** when it is not available, they are read with pread on a thread.
+        */
+        bool io_uring = true;
+    };
+
+    namespace details
+    {
+        /*
+        ** The consumer parses the block it holds while the other buffers of a fixed pool are filled
+        ** ahead, and gives its block back when moving to the next one, so that reading and parsing
+        ** overlap and nothing is allocated or copied once started.
+        **
+        ** Seekable descriptors are read at explicit offsets, one read per free buffer, from the
+        ** position the descriptor is at, which is left untouched. The reads are submitted through
+        ** io_uring, so that they are all in flight at once without any thread, and completions
+        ** are reaped by the consumer when it needs the next block. Where io_uring cannot be set
+        ** up, a thread fills the free buffers in order with pread instead. Other descriptors, like
+        ** pipes and sockets, can only be read in order, so a thread reads them with read.
+        **
+        ** The reading thread and the consumer each sleep on their own condition variable, and are
+        ** only woken by the other when there is a block for them: the thread when a buffer is
+        ** freed, the consumer when one is filled or the file is over.
+        */
+        class block_stream
+        {
+        public:
+            using block_type = range<const char *>;
+
+            block_stream(int fd, std::size_t block_size, const block_options &opts) :
+                _fd(fd), _block_size(std::max<std::size_t>(block_size, 1)), _drop_cache(opts.drop_cache)
+            {
+                auto buffers = std::max<std::size_t>(opts.buffers, 2);
+
+                for (std::size_t i = 0; i < buffers; ++i) {
+                    _storage.emplace_back(new char[_block_size]);
+                    _slots.push_back({_storage.back().get()});
+                }
+                _offset = ::lseek(_fd, 0, SEEK_CUR);
+                if (_offset >= 0) {
+#ifdef POSIX_FADV_SEQUENTIAL
+                    ::posix_fadvise(_fd, _offset, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+                }
+                if (_offset >= 0 && opts.io_uring) {
+                    _ring = _acquire_ring(static_cast<unsigned>(buffers));
+                }
+                if (_ring.valid()) {
+                    for (std::size_t i = 0; i < _slots.size(); ++i) {
+                        _submit(i);
+                    }
+                } else {
+                    for (auto &slot : _slots) {
+                        _free.push_back(&slot);
+                    }
+                    _reader = std::thread([this] { _read_all(); });
+                }
+            }
+
+            block_stream(const block_stream &) = delete;
+
+            block_stream &operator=(const block_stream &) = delete;
+
+            /*
+            ** Reads in flight are waited for: destroying a stream over a pipe nobody writes to
+            ** blocks until the writer closes it.
+            */
+            ~block_stream()
+            {
+                if (_ring.valid()) {
+                    while (_in_flight != 0) {
+                        _complete(_ring.wait());
+                    }
+                    _release_ring(std::move(_ring));
+                    return;
+                }
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    _stopping = true;
+                }
+                _freed.notify_one();
+                _reader.join();
+            }
+
+            /*
+            ** Gives the current block back to the pool and waits for the next one. Returns false at
+            ** the end of the file, and throws std::system_error when reading failed.
+            */
+            bool next()
+            {
+                return _ring.valid() ? _next_completed() : _next_queued();
+            }
+
+            block_type current() const noexcept
+            {
+                if (_current == nullptr) {
+                    return block_type(nullptr, nullptr);
+                }
+                return block_type(_current->data, _current->data + _current->size);
+            }
+
+        private:
+            static constexpr auto no_end = std::numeric_limits<std::uint64_t>::max();
+
+            /*
+            ** Setting a ring up and tearing it down costs more than reading a small file, so idle
+            ** rings are kept for the next streams of the same thread.
+            */
+            static constexpr std::size_t max_idle_rings = 4;
+
+            static std::vector<io_ring> &_idle_rings()
+            {
+                thread_local std::vector<io_ring> rings;
+
+                return rings;
+            }
+
+            static io_ring _acquire_ring(unsigned entries)
+            {
+                auto &rings = _idle_rings();
+                auto found = std::find_if(rings.begin(), rings.end(), [entries](const io_ring &ring) {
+                    return ring.entries() >= entries;
+                });
+
+                if (found == rings.end()) {
+                    return io_ring(entries);
+                }
+
+                auto ring = std::move(*found);
+
+                rings.erase(found);
+                return ring;
+            }
+
+            static void _release_ring(io_ring ring)
+            {
+                auto &rings = _idle_rings();
+
+                if (rings.size() < max_idle_rings) {
+                    rings.push_back(std::move(ring));
+                }
+            }
+
+            struct slot
+            {
+                char *data;
+                std::size_t size = 0;
+                std::uint64_t sequence = 0;
+                int error = 0;
+                bool done = false;
+            };
+
+            off_t _offset_of(std::uint64_t sequence) const noexcept
+            {
+                return _offset + static_cast<off_t>(sequence * _block_size);
+            }
+
+            void _drop(const slot &s) noexcept
+            {
+#ifdef POSIX_FADV_DONTNEED
+                if (_drop_cache && _offset >= 0) {
+                    ::posix_fadvise(_fd, _offset_of(s.sequence), static_cast<off_t>(s.size), POSIX_FADV_DONTNEED);
+                }
+#else
+                (void)s;
+#endif
+            }
+
+            /*
+            ** Queues the read of what the block of the slot still lacks.
+            */
+            void _queue_read(std::size_t index)
+            {
+                auto &s = _slots[index];
+                auto offset = static_cast<std::uint64_t>(_offset_of(s.sequence)) + s.size;
+
+                _ring.read(_fd, s.data + s.size, _block_size - s.size, offset, index);
+                ++_in_flight;
+            }
+
+            void _submit(std::size_t index)
+            {
+                auto &s = _slots[index];
+
+                s.sequence = _submitted++;
+                s.size = 0;
+                s.error = 0;
+                s.done = false;
+                _queue_read(index);
+            }
+
+            /*
+            ** Reads of regular files only come short at the end of the file, which the next read
+            ** confirms by returning nothing, while reads of other seekable descriptors may come
+            ** short anywhere: either way, a block is complete once full or once a read returned
+            ** nothing.
+            */
+            void _complete(const io_ring::completion &completion)
+            {
+                auto index = static_cast<std::size_t>(completion.user_data);
+                auto &s = _slots[index];
+
+                --_in_flight;
+                if (completion.result == -EINTR || completion.result == -EAGAIN) {
+                    _queue_read(index);
+                } else if (completion.result < 0) {
+                    s.error = -completion.result;
+                    s.done = true;
+                    _end = std::min(_end, s.sequence);
+                } else if (completion.result == 0) {
+                    s.done = true;
+                    _end = std::min(_end, s.sequence);
+                } else {
+                    s.size += static_cast<std::size_t>(completion.result);
+                    s.done = s.size == _block_size;
+                    if (!s.done) {
+                        _queue_read(index);
+                    }
+                }
+            }
+
+            /*
+            ** Blocks are completed in any order, but handed over in the order of the file. A slot
+            ** is only submitted again while the end of the file is not known to come before it.
+            */
+            bool _next_completed()
+            {
+                if (_current != nullptr) {
+                    _drop(*_current);
+                    if (_submitted <= _end) {
+                        _submit(static_cast<std::size_t>(_current - _slots.data()));
+                    }
+                    _current = nullptr;
+                }
+                if (_delivered > _end) {
+                    return false;
+                }
+
+                slot *wanted = nullptr;
+
+                for (auto &s : _slots) {
+                    if (s.sequence == _delivered) {
+                        wanted = &s;
+                    }
+                }
+                while (!wanted->done) {
+                    _complete(_ring.wait());
+                }
+                if (wanted->error != 0) {
+                    _delivered = _end + 1;
+                    throw std::system_error(wanted->error, std::generic_category(), "smite: cannot read");
+                }
+                if (wanted->size == 0) {
+                    _delivered = _end + 1;
+                    return false;
+                }
+                _current = wanted;
+                ++_delivered;
+                return true;
+            }
+
+            bool _next_queued()
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+
+                if (_current != nullptr) {
+                    _free.push_back(_current);
+                    _current = nullptr;
+                    _freed.notify_one();
+                }
+                _filled.wait(lock, [this] { return !_ready.empty() || _finished; });
+                if (!_ready.empty()) {
+                    _current = _ready.front();
+                    _ready.pop_front();
+                    return true;
+                }
+                if (_error != 0) {
+                    throw std::system_error(std::exchange(_error, 0), std::generic_category(), "smite: cannot read");
+                }
+                return false;
+            }
+
+            /*
+            ** Fills a whole block unless the end of the file comes first, so that pipes, which
+            ** return whatever was written, give blocks of the same size as files.
+            */
+            std::size_t _fill(slot &s, int &error)
+            {
+                std::size_t filled = 0;
+
+                while (filled < _block_size) {
+                    auto n = _offset >= 0
+                             ? ::pread(_fd, s.data + filled, _block_size - filled, _offset_of(s.sequence) + static_cast<off_t>(filled))
+                             : ::read(_fd, s.data + filled, _block_size - filled);
+
+                    if (n < 0 && errno == EINTR) {
+                        continue;
+                    }
+                    if (n < 0) {
+                        error = errno;
+                        break;
+                    }
+                    if (n == 0) {
+                        break;
+                    }
+                    filled += static_cast<std::size_t>(n);
+                }
+                return filled;
+            }
+
+            void _read_all()
+            {
+                for (std::uint64_t sequence = 0;; ++sequence) {
+                    slot *s = nullptr;
+
+                    {
+                        std::unique_lock<std::mutex> lock(_mutex);
+
+                        _freed.wait(lock, [this] { return !_free.empty() || _stopping; });
+                        if (_stopping) {
+                            return;
+                        }
+                        s = _free.back();
+                        _free.pop_back();
+                    }
+
+                    int error = 0;
+
+                    s->sequence = sequence;
+                    s->size = _fill(*s, error);
+                    _drop(*s);
+                    {
+                        std::lock_guard<std::mutex> lock(_mutex);
+
+                        if (s->size != 0) {
+                            _ready.push_back(s);
+                        } else {
+                            _free.push_back(s);
+                        }
+                        if (s->size < _block_size) {
+                            _error = error;
+                            _finished = true;
+                        }
+                    }
+                    _filled.notify_one();
+                    if (s->size < _block_size) {
+                        return;
+                    }
+                }
+            }
+
+            int _fd;
+            std::size_t _block_size;
+            bool _drop_cache;
+            off_t _offset;
+            std::vector<std::unique_ptr<char[]>> _storage;
+            std::vector<slot> _slots;
+            slot *_current = nullptr;
+            io_ring _ring;
+            std::uint64_t _submitted = 0;
+            std::uint64_t _delivered = 0;
+            std::uint64_t _end = no_end;
+            std::size_t _in_flight = 0;
+            std::vector<slot *> _free;
+            std::deque<slot *> _ready;
+            int _error = 0;
+            bool _finished = false;
+            bool _stopping = false;
+            std::mutex _mutex;
+            std::condition_variable _freed;
+            std::condition_variable _filled;
+            std::thread _reader;
+        };
+    }
+
+    /*
+    ** Iterates over the blocks of a block_reader. Each block is a view over a buffer of the pool,
+    ** valid until the iterator is incremented.
+    */
+    class block_iterator
+    {
+    public:
+        using difference_type = std::ptrdiff_t;
+        using value_type = details::block_stream::block_type;
+        using reference = value_type;
+        using pointer = details::fake_ptr<value_type>;
+        using iterator_category = std::input_iterator_tag;
+
+        constexpr block_iterator() noexcept = default;
+
+        explicit block_iterator(details::block_stream *stream) : _stream(stream)
+        {
+            _advance();
+        }
+
+        reference operator*() const noexcept
+        {
+            return _stream->current();
+        }
+
+        pointer operator->() const noexcept
+        {
+            return pointer{**this};
+        }
+
+        block_iterator &operator++()
+        {
+            _advance();
+            return *this;
+        }
+
+        void operator++(int)
+        {
+            ++*this;
+        }
+
+        bool operator==(const block_iterator &other) const noexcept
+        {
+            return _stream == other._stream;
+        }
+
+        bool operator!=(const block_iterator &other) const noexcept
+        {
+            return !(*this == other);
+        }
+
+    private:
+        void _advance()
+        {
+            if (!_stream->next()) {
+                _stream = nullptr;
+            }
+        }
+
+        details::block_stream *_stream = nullptr;
+    };
+
+    /*
+    ** An input range over the blocks of a file descriptor, read ahead of the consumer. It can only
+    ** be walked once, and does not close the descriptor.
+    */
+    class block_reader
+    {
+    public:
+        block_reader(int fd, std::size_t block_size, const block_options &opts = {}) :
+            _stream(std::make_unique<details::block_stream>(fd, block_size, opts))
+        {
+        }
+
+        block_iterator begin() const
+        {
+            return block_iterator(_stream.get());
+        }
+
+        block_iterator end() const noexcept
+        {
+            return block_iterator();
+        }
+
+    private:
+        std::unique_ptr<details::block_stream> _stream;
+    };
+
+    /*
+    ** Reads fd by blocks of block_size bytes, the last one holding what is left. It works on
+    ** files, pipes and sockets alike, and throws std::system_error when a read fails.
+    */
+    inline block_reader read_blocks(int fd, std::size_t block_size, const block_options &opts = {})
+    {
+        return block_reader(fd, block_size, opts);
+    }
+}
+
+#endif /* !SMITE_READ_BLOCKS_HPP */
@@ -0,0 +1,330 @@
+/*
+** Created by doom on 18/10/26.
+*/
+
+#ifndef SMITE_REDUCE_HPP
+#define SMITE_REDUCE_HPP
+
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <smite/range.hpp>
+#include <smite/details/indexed_access.hpp>
+#include <smite/details/push.hpp>
+
+namespace smite
+{
+    namespace details
+    {
+        /*
+        ** Operations on arithmetic types for which the lanes of the reduction kernel can start from
+        ** a neutral element.
+        */
+        template <typename Op, typename T, typename = void>
+        struct reduce_identity
+        {
+            static constexpr bool value = false;
+        };
+
+        template <typename U, typename T>
+        struct reduce_identity<std::plus<U>, T, std::enable_if_t<std::is_arithmetic_v<T>>>
+        {
+            static constexpr bool value = true;
+
+            static constexpr T get()
+            {
+                return T{};
+            }
+        };
+
+        template <typename U, typename T>
+        struct reduce_identity<std::multiplies<U>, T, std::enable_if_t<std::is_arithmetic_v<T>>>
+        {
+            static constexpr bool value = true;
+
+            static constexpr T get()
+            {
+                return T{1};
+            }
+        };
+
+        template <typename U, typename T>
+        struct reduce_identity<std::bit_or<U>, T, std::enable_if_t<std::is_integral_v<T>>>
+        {
+            static constexpr bool value = true;
+
+            static constexpr T get()
+            {
+                return T{};
+            }
+        };
+
+        template <typename U, typename T>
+        struct reduce_identity<std::bit_xor<U>, T, std::enable_if_t<std::is_integral_v<T>>>
+        {
+            static constexpr bool value = true;
+
+            static constexpr T get()
+            {
+                return T{};
+            }
+        };
+
+        template <typename U, typename T>
+        struct reduce_identity<std::bit_and<U>, T, std::enable_if_t<std::is_integral_v<T>>>
+        {
+            static constexpr bool value = true;
+
+            static constexpr T get()
+            {
+                return static_cast<T>(~T{});
+            }
+        };
+
+        inline constexpr std::ptrdiff_t reduce_lanes = 8;
+
+        template <typename T, std::size_t ...Is>
+        constexpr std::array<T, sizeof...(Is)> make_lanes(const T &value, std::index_sequence<Is...>)
+        {
+            return {{(static_cast<void>(Is), value)...}};
+        }
+
+        /*
+        ** Folds into several independent accumulators, so that consecutive iterations do not wait
+        ** on each other and the compiler can map the lanes onto vector registers. This reorders
+        ** the operations, which is only valid for associative and commutative ones, like for
+        ** std::reduce.
+        */
+        template <typename T, typename Access, typename BinaryOp>
+        constexpr T reduce_kernel(const Access &access, std::ptrdiff_t n, T init, BinaryOp op, const T &identity)
+        {
+            auto lanes = make_lanes(identity, std::make_index_sequence<reduce_lanes>{});
+            auto full = n - n % reduce_lanes;
+            std::ptrdiff_t i = 0;
+
+            for (; i < full; i += reduce_lanes) {
+                for (std::ptrdiff_t k = 0; k < reduce_lanes; ++k) {
+                    lanes[k] = op(std::move(lanes[k]), access(i + k));
+                }
+            }
+            for (; i < n; ++i) {
+                lanes[0] = op(std::move(lanes[0]), access(i));
+            }
+            for (auto &lane : lanes) {
+                init = op(std::move(init), std::move(lane));
+            }
+            return init;
+        }
+
+        template <typename T, typename Access, typename BinaryOp>
+        constexpr T reduce_indexed(const Access &access, std::ptrdiff_t n, T init, BinaryOp op)
+        {
+            if constexpr (reduce_identity<BinaryOp, T>::value) {
+                return reduce_kernel(access, n, std::move(init), op, reduce_identity<BinaryOp, T>::get());
+            } else {
+                for (std::ptrdiff_t i = 0; i < n; ++i) {
+                    init = op(std::move(init), access(i));
+                }
+                return init;
+            }
+        }
+
+        template <typename T, typename Access>
+        constexpr std::pair<T, T> min_max_kernel(const Access &access, std::ptrdiff_t n)
+        {
+            T first = access(0);
+            auto lows = make_lanes(first, std::make_index_sequence<reduce_lanes>{});
+            auto highs = lows;
+            auto full = 1 + (n - 1) - (n - 1) % reduce_lanes;
+            std::ptrdiff_t i = 1;
+
+            for (; i < full; i += reduce_lanes) {
+                for (std::ptrdiff_t k = 0; k < reduce_lanes; ++k) {
+                    T value = access(i + k);
+
+                    lows[k] = value < lows[k] ? value : lows[k];
+                    highs[k] = highs[k] < value ? value : highs[k];
+                }
+            }
+            for (; i < n; ++i) {
+                T value = access(i);
+
+                lows[0] = value < lows[0] ? value : lows[0];
+                highs[0] = highs[0] < value ? value : highs[0];
+            }
+            return {*std::min_element(lows.begin(), lows.end()), *std::max_element(highs.begin(), highs.end())};
+        }
+
+        template <typename Range>
+        using range_value_t = std::decay_t<decltype(*std::begin(std::declval<Range &>()))>;
+    }
+
+    /*
+    ** Folds rng into init with op. When the range is made of transforms, zips and enumerations
+    ** over contiguous memory, the fold runs over plain indices, in several lanes for the usual
+    ** arithmetic operations. op must thus be associative and commutative.
+    */
+    template <typename Range, typename T, typename BinaryOp>
+    inline constexpr T reduce(Range &&rng, T init, BinaryOp op)
+    {
+        auto first = std::begin(rng);
+        auto last = std::end(rng);
+
+        if constexpr (details::is_indexable_v<decltype(first), decltype(last)>) {
+            auto n = static_cast<std::ptrdiff_t>(last - first);
+
+            if (n <= 0) {
+                return init;
+            }
+            return details::reduce_indexed(details::make_indexed_access(first), n, std::move(init), op);
+        } else {
+            details::for_each_until(std::move(first), last, [&init, &op](auto &&value) {
+                init = op(std::move(init), std::forward<decltype(value)>(value));
+                return false;
+            });
+            return init;
+        }
+    }
+
+    template <typename Range, typename T>
+    inline constexpr T sum(Range &&rng, T init)
+    {
+        return reduce(std::forward<Range>(rng), std::move(init), std::plus<>{});
+    }
+
+    template <typename Range>
+    inline constexpr auto sum(Range &&rng)
+    {
+        return sum(std::forward<Range>(rng), details::range_value_t<Range>{});
+    }
+
+    template <typename Range>
+    inline constexpr std::ptrdiff_t count(Range &&rng)
+    {
+        auto first = std::begin(rng);
+        auto last = std::end(rng);
+
+        if constexpr (details::is_common_v<decltype(first), decltype(last)>) {
+            return static_cast<std::ptrdiff_t>(std::distance(first, last));
+        } else {
+            std::ptrdiff_t n = 0;
+
+            details::for_each_until(std::move(first), last, [&n](auto &&) {
+                ++n;
+                return false;
+            });
+            return n;
+        }
+    }
+
+    template <typename Range, typename Predicate>
+    inline constexpr std::ptrdiff_t count_if(Range &&rng, Predicate pred)
+    {
+        auto first = std::begin(rng);
+        auto last = std::end(rng);
+
+        if constexpr (details::is_indexable_v<decltype(first), decltype(last)>) {
+            auto n = static_cast<std::ptrdiff_t>(last - first);
+
+            if (n <= 0) {
+                return 0;
+            }
+            auto access = details::make_indexed_access(first);
+            auto matches = [&access, &pred](std::ptrdiff_t i) {
+                return static_cast<std::ptrdiff_t>(static_cast<bool>(pred(access(i))));
+            };
+            return details::reduce_indexed(matches, n, std::ptrdiff_t{0}, std::plus<>{});
+        } else {
+            std::ptrdiff_t n = 0;
+
+            details::for_each_until(std::move(first), last, [&n, &pred](auto &&value) {
+                n += static_cast<bool>(pred(value));
+                return false;
+            });
+            return n;
+        }
+    }
+
+    /*
+    ** Returns the smallest and the largest elements of rng, or nothing when it is empty.
+    */
+    template <typename Range>
+    inline constexpr auto min_max(Range &&rng)
+    {
+        using value_type = details::range_value_t<Range>;
+        auto first = std::begin(rng);
+        auto last = std::end(rng);
+
+        if constexpr (details::is_indexable_v<decltype(first), decltype(last)> && std::is_arithmetic_v<value_type>) {
+            auto n = static_cast<std::ptrdiff_t>(last - first);
+
+            if (n <= 0) {
+                return std::optional<std::pair<value_type, value_type>>{};
+            }
+            auto access = details::make_indexed_access(first);
+            return std::optional<std::pair<value_type, value_type>>{details::min_max_kernel<value_type>(access, n)};
+        } else {
+            std::optional<std::pair<value_type, value_type>> bounds;
+
+            details::for_each_until(std::move(first), last, [&bounds](auto &&value) {
+                if (!bounds) {
+                    bounds.emplace(value, value);
+                } else if (value < bounds->first) {
+                    bounds->first = std::forward<decltype(value)>(value);
+                } else if (!(value < bounds->second)) {
+                    bounds->second = std::forward<decltype(value)>(value);
+                }
+                return false;
+            });
+            return bounds;
+        }
+    }
+
+    /*
+    ** Sums the products of the elements of lhs and rhs, stopping at the end of the shortest one.
+    */
+    template <typename Range1, typename Range2, typename T>
+    inline constexpr T dot(Range1 &&lhs, Range2 &&rhs, T init)
+    {
+        auto first1 = std::begin(lhs);
+        auto last1 = std::end(lhs);
+        auto first2 = std::begin(rhs);
+        auto last2 = std::end(rhs);
+
+        if constexpr (details::is_indexable_v<decltype(first1), decltype(last1)> &&
+                      details::is_indexable_v<decltype(first2), decltype(last2)>) {
+            auto n = static_cast<std::ptrdiff_t>(std::min(last1 - first1, last2 - first2));
+
+            if (n <= 0) {
+                return init;
+            }
+            auto access1 = details::make_indexed_access(first1);
+            auto access2 = details::make_indexed_access(first2);
+            auto products = [&access1, &access2](std::ptrdiff_t i) {
+                return access1(i) * access2(i);
+            };
+            return details::reduce_indexed(products, n, std::move(init), std::plus<>{});
+        } else {
+            for (; first1 != last1 && first2 != last2; ++first1, ++first2) {
+                init = std::move(init) + *first1 * *first2;
+            }
+            return init;
+        }
+    }
+
+    template <typename Range1, typename Range2>
+    inline constexpr auto dot(Range1 &&lhs, Range2 &&rhs)
+    {
+        using value_type = decltype(std::declval<details::range_value_t<Range1>>() *
+                                    std::declval<details::range_value_t<Range2>>());
+
+        return dot(std::forward<Range1>(lhs), std::forward<Range2>(rhs), value_type{});
+    }
+}
+
+#endif /* !SMITE_REDUCE_HPP */
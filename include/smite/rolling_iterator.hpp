@@ -0,0 +1,466 @@
+/*
+** Created by doom on 18/10/26.
+*/
+
+#ifndef SMITE_ROLLING_ITERATOR_HPP
+#define SMITE_ROLLING_ITERATOR_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+#include <smite/range.hpp>
+#include <smite/sliding_iterator.hpp>
+#include <smite/details/fake_ptr.hpp>
+
+namespace smite
+{
+    /*
+    ** Incremental operations for rolling. Sums and means add the element entering the window and
+    ** subtract the one leaving it, which is exact for integers but lets rounding errors pile up
+    ** for floating-point elements over very long series.
+    */
+    struct rolling_sum
+    {
+    };
+
+    struct rolling_mean
+    {
+    };
+
+    struct rolling_min
+    {
+    };
+
+    struct rolling_max
+    {
+    };
+
+    namespace details
+    {
+        /*
+        ** Integers are summed in the widest type of their signedness, so that a window does not
+        ** overflow where its elements do not.
+        */
+        template <typename T>
+        using rolling_accumulator_t = std::conditional_t<
+            std::is_integral_v<T>,
+            std::conditional_t<std::is_signed_v<T>, long long, unsigned long long>,
+            T
+        >;
+
+        /*
+        ** The state of an operation over the current window. init is given the iterator on the
+        ** first window, slide the element which just left and the iterator on the new window.
+        ** Other operations are folded over the whole window each time, which costs O(size).
+        */
+        template <typename Op, typename T>
+        class rolling_state
+        {
+        public:
+            using value_type = T;
+
+            constexpr explicit rolling_state(Op op, std::size_t) : _op(std::move(op)), _value()
+            {
+            }
+
+            template <typename WindowIter>
+            constexpr void init(const WindowIter &it)
+            {
+                _fold(*it);
+            }
+
+            template <typename WindowIter>
+            constexpr void slide(const T &, const WindowIter &it)
+            {
+                _fold(*it);
+            }
+
+            constexpr const value_type &value() const noexcept
+            {
+                return _value;
+            }
+
+        private:
+            template <typename Window>
+            constexpr void _fold(const Window &window)
+            {
+                auto first = std::begin(window);
+                auto last = std::end(window);
+
+                _value = *first;
+                for (++first; first != last; ++first) {
+                    _value = _op(std::move(_value), *first);
+                }
+            }
+
+            Op _op;
+            value_type _value;
+        };
+
+        template <typename T>
+        class rolling_state<rolling_sum, T>
+        {
+        public:
+            using value_type = rolling_accumulator_t<T>;
+
+            constexpr explicit rolling_state(rolling_sum, std::size_t) noexcept : _value()
+            {
+            }
+
+            template <typename WindowIter>
+            constexpr void init(const WindowIter &it)
+            {
+                for (auto &&value : *it) {
+                    _value += value;
+                }
+            }
+
+            template <typename WindowIter>
+            constexpr void slide(const T &leaving, const WindowIter &it)
+            {
+                _value += it.back();
+                _value -= leaving;
+            }
+
+            constexpr const value_type &value() const noexcept
+            {
+                return _value;
+            }
+
+        private:
+            value_type _value;
+        };
+
+        template <typename T>
+        class rolling_state<rolling_mean, T>
+        {
+        public:
+            using value_type = std::conditional_t<std::is_floating_point_v<T>, T, double>;
+
+            constexpr explicit rolling_state(rolling_mean, std::size_t size) noexcept :
+                _sum(rolling_sum{}, size), _size(size), _value()
+            {
+            }
+
+            template <typename WindowIter>
+            constexpr void init(const WindowIter &it)
+            {
+                _sum.init(it);
+                _update();
+            }
+
+            template <typename WindowIter>
+            constexpr void slide(const T &leaving, const WindowIter &it)
+            {
+                _sum.slide(leaving, it);
+                _update();
+            }
+
+            constexpr const value_type &value() const noexcept
+            {
+                return _value;
+            }
+
+        private:
+            constexpr void _update() noexcept
+            {
+                _value = static_cast<value_type>(_sum.value()) / static_cast<value_type>(_size);
+            }
+
+            rolling_state<rolling_sum, T> _sum;
+            std::size_t _size;
+            value_type _value;
+        };
+
+        /*
+        ** Keeps the candidates for the extremum of the window and of the windows after it: each is
+        ** better than all of those entered before it, so that the front is the extremum. An element
+        ** enters and leaves the deque once, which costs O(1) amortized per window. The deque never
+        ** holds more than size elements, and lives in a ring buffer of that capacity.
+        */
+        template <typename T, typename Better>
+        class rolling_extremum_state
+        {
+        public:
+            using value_type = T;
+
+            explicit rolling_extremum_state(std::size_t size) : _ring(size), _size(size)
+            {
+            }
+
+            template <typename WindowIter>
+            void init(const WindowIter &it)
+            {
+                for (auto &&value : *it) {
+                    _push(value);
+                }
+            }
+
+            template <typename WindowIter>
+            void slide(const T &, const WindowIter &it)
+            {
+                if (_ring[_head].first + _size == _index) {
+                    _head = _wrap(_head + 1);
+                    --_count;
+                }
+                _push(it.back());
+            }
+
+            const value_type &value() const noexcept
+            {
+                return _ring[_head].second;
+            }
+
+        private:
+            std::size_t _wrap(std::size_t slot) const noexcept
+            {
+                return slot >= _size ? slot - _size : slot;
+            }
+
+            void _push(const T &value)
+            {
+                while (_count != 0 && !Better{}(_ring[_wrap(_head + _count - 1)].second, value)) {
+                    --_count;
+                }
+                _ring[_wrap(_head + _count)] = {_index++, value};
+                ++_count;
+            }
+
+            std::vector<std::pair<std::size_t, T>> _ring;
+            std::size_t _size;
+            std::size_t _head = 0;
+            std::size_t _count = 0;
+            std::size_t _index = 0;
+        };
+
+        template <typename T>
+        struct rolling_less
+        {
+            constexpr bool operator()(const T &lhs, const T &rhs) const
+            {
+                return lhs < rhs;
+            }
+        };
+
+        template <typename T>
+        struct rolling_greater
+        {
+            constexpr bool operator()(const T &lhs, const T &rhs) const
+            {
+                return rhs < lhs;
+            }
+        };
+
+        template <typename T>
+        class rolling_state<rolling_min, T> : public rolling_extremum_state<T, rolling_less<T>>
+        {
+        public:
+            explicit rolling_state(rolling_min, std::size_t size) :
+                rolling_extremum_state<T, rolling_less<T>>(size)
+            {
+            }
+        };
+
+        template <typename T>
+        class rolling_state<rolling_max, T> : public rolling_extremum_state<T, rolling_greater<T>>
+        {
+        public:
+            explicit rolling_state(rolling_max, std::size_t size) :
+                rolling_extremum_state<T, rolling_greater<T>>(size)
+            {
+            }
+        };
+    }
+
+    /*
+    ** Yields op over every window of a sliding range, updating it from the element leaving the
+    ** window and the one entering it rather than going over the whole window again. Copies of the
+    ** iterator carry their own state.
+    */
+    template <typename WindowIter, typename WindowSentinel, typename Op>
+    class rolling_iterator
+    {
+    public:
+        using iterator_type = WindowIter;
+        using sentinel_type = WindowSentinel;
+
+    private:
+        using window_type = typename std::iterator_traits<WindowIter>::value_type;
+        using element_type = std::decay_t<decltype(*std::begin(std::declval<const window_type &>()))>;
+        using state_type = details::rolling_state<Op, element_type>;
+
+    public:
+        using difference_type = typename std::iterator_traits<WindowIter>::difference_type;
+        using value_type = typename state_type::value_type;
+        using reference = const value_type &;
+        using pointer = const value_type *;
+        using iterator_category = std::conditional_t<
+            std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<WindowIter>::iterator_category>,
+            std::forward_iterator_tag,
+            std::input_iterator_tag
+        >;
+
+        constexpr rolling_iterator(WindowIter window, WindowSentinel end, Op op, std::size_t size) :
+            _window(std::move(window)), _end(std::move(end)), _state(std::move(op), size)
+        {
+            if (_window != _end) {
+                _state.init(_window);
+            }
+        }
+
+        constexpr rolling_iterator(const rolling_iterator &) = default;
+
+        constexpr rolling_iterator(rolling_iterator &&) = default;
+
+        constexpr rolling_iterator &operator=(const rolling_iterator &) = default;
+
+        constexpr rolling_iterator &operator=(rolling_iterator &&) = default;
+
+        constexpr reference operator*() const noexcept
+        {
+            return _state.value();
+        }
+
+        constexpr pointer operator->() const noexcept
+        {
+            return &_state.value();
+        }
+
+        /*
+        ** The element leaving the window is copied first, as input windows are overwritten when
+        ** moving to the next one.
+        */
+        constexpr rolling_iterator &operator++()
+        {
+            element_type leaving = _window.front();
+
+            ++_window;
+            if (_window != _end) {
+                _state.slide(leaving, _window);
+            }
+            return *this;
+        }
+
+        constexpr const rolling_iterator operator++(int)
+        {
+            auto tmp = *this;
+
+            ++*this;
+            return tmp;
+        }
+
+        constexpr const iterator_type &base() const noexcept
+        {
+            return _window;
+        }
+
+        constexpr const sentinel_type &sentinel() const noexcept
+        {
+            return _end;
+        }
+
+    private:
+        WindowIter _window;
+        WindowSentinel _end;
+        state_type _state;
+    };
+
+    template <typename WindowIter, typename WindowSentinel, typename Op>
+    inline constexpr bool operator==(const rolling_iterator<WindowIter, WindowSentinel, Op> &lhs,
+                                     const rolling_iterator<WindowIter, WindowSentinel, Op> &rhs)
+    {
+        return lhs.base() == rhs.base();
+    }
+
+    template <typename WindowIter, typename WindowSentinel, typename Op>
+    inline constexpr bool operator!=(const rolling_iterator<WindowIter, WindowSentinel, Op> &lhs,
+                                     const rolling_iterator<WindowIter, WindowSentinel, Op> &rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+    template <typename WindowIter, typename WindowSentinel, typename Op, typename BaseSentinel>
+    inline constexpr bool operator==(const rolling_iterator<WindowIter, WindowSentinel, Op> &lhs,
+                                     const adaptor_sentinel<BaseSentinel> &rhs)
+    {
+        return lhs.base() == rhs.base();
+    }
+
+    template <typename WindowIter, typename WindowSentinel, typename Op, typename BaseSentinel>
+    inline constexpr bool operator==(const adaptor_sentinel<BaseSentinel> &lhs,
+                                     const rolling_iterator<WindowIter, WindowSentinel, Op> &rhs)
+    {
+        return rhs == lhs;
+    }
+
+    template <typename WindowIter, typename WindowSentinel, typename Op, typename BaseSentinel>
+    inline constexpr bool operator!=(const rolling_iterator<WindowIter, WindowSentinel, Op> &lhs,
+                                     const adaptor_sentinel<BaseSentinel> &rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+    template <typename WindowIter, typename WindowSentinel, typename Op, typename BaseSentinel>
+    inline constexpr bool operator!=(const adaptor_sentinel<BaseSentinel> &lhs,
+                                     const rolling_iterator<WindowIter, WindowSentinel, Op> &rhs)
+    {
+        return !(rhs == lhs);
+    }
+
+    namespace details
+    {
+        template <typename WindowIter, typename WindowSentinel, typename Op>
+        struct sentinel_traits<rolling_iterator<WindowIter, WindowSentinel, Op>> :
+            adaptor_sentinel_traits<rolling_iterator<WindowIter, WindowSentinel, Op>>
+        {
+        };
+    }
+
+    /*
+    ** Yields op over every window of size consecutive elements of container. op is one of
+    ** rolling_sum, rolling_mean, rolling_min and rolling_max, which cost O(1) amortized per
+    ** window, or any binary operation, folded over each window in turn. size must be positive.
+    */
+    template <typename Container, typename Op>
+    inline constexpr auto rolling(Container &&container, std::size_t size, Op op)
+    {
+        assert(size > 0 && "rolling needs a positive size");
+
+        auto windows = sliding(std::forward<Container>(container), size);
+        auto first = windows.begin();
+        auto last = windows.end();
+        using iterator = rolling_iterator<decltype(first), decltype(last), Op>;
+
+        return make_range(iterator(first, last, std::move(op), size), adaptor_sentinel<decltype(last)>(last));
+    }
+
+    namespace details
+    {
+        template <typename Op>
+        struct rolling_maker
+        {
+            using smite_tag = range_maker_tag;
+
+            template <typename Range>
+            constexpr auto operator()(Range &&rng) const
+            {
+                return rolling(std::forward<Range>(rng), _size, _op);
+            }
+
+            std::size_t _size;
+            Op _op;
+        };
+    }
+
+    template <typename Op>
+    inline constexpr auto make_rolling(std::size_t size, Op op)
+    {
+        assert(size > 0 && "rolling needs a positive size");
+        return details::rolling_maker<Op>{size, std::move(op)};
+    }
+}
+
+#endif /* !SMITE_ROLLING_ITERATOR_HPP */
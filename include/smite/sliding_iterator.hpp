@@ -0,0 +1,438 @@
+/*
+** Created by doom on 18/10/26.
+*/
+
+#ifndef SMITE_SLIDING_ITERATOR_HPP
+#define SMITE_SLIDING_ITERATOR_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+#include <smite/range.hpp>
+#include <smite/chunk_iterator.hpp>
+#include <smite/details/fake_ptr.hpp>
+
+namespace smite
+{
+    /*
+    ** Iterates over the windows of size consecutive elements of a forward range, each window
+    ** starting one element after the previous one. A window is a view over its base, like the
+    ** chunks of chunk, and moving to the next one moves both of its ends by one element.
+    */
+    template <typename Iter, typename Sentinel = Iter>
+    class sliding_iterator
+    {
+    public:
+        using iterator_type = Iter;
+        using sentinel_type = Sentinel;
+
+    private:
+        using iterator_traits = std::iterator_traits<Iter>;
+
+        static constexpr bool is_random_access = details::is_common_v<Iter, Sentinel> &&
+                                                 details::has_constant_jumps_v<Iter>;
+
+    public:
+        using difference_type = typename iterator_traits::difference_type;
+        using value_type = typename details::chunk_traits<Iter>::type;
+        using reference = value_type;
+        using pointer = details::fake_ptr<value_type>;
+        using iterator_category = std::conditional_t<
+            is_random_access,
+            std::random_access_iterator_tag,
+            std::forward_iterator_tag
+        >;
+
+        /*
+        ** last is the last element of the window, or end when the range is too short for one.
+        */
+        constexpr sliding_iterator(Iter first, Iter last, std::size_t size) :
+            _first(first), _last(last), _size(size)
+        {
+        }
+
+        constexpr sliding_iterator(const sliding_iterator &) = default;
+
+        constexpr sliding_iterator(sliding_iterator &&) = default;
+
+        constexpr sliding_iterator &operator=(const sliding_iterator &) = default;
+
+        constexpr sliding_iterator &operator=(sliding_iterator &&) = default;
+
+        constexpr reference operator*() const
+        {
+            return details::chunk_traits<Iter>::make(_first, std::next(_last));
+        }
+
+        constexpr pointer operator->() const
+        {
+            return pointer{**this};
+        }
+
+        constexpr reference operator[](difference_type n) const
+        {
+            return *(*this + n);
+        }
+
+        /*
+        ** The element leaving the window when moving to the next one.
+        */
+        constexpr decltype(auto) front() const
+        {
+            return *_first;
+        }
+
+        /*
+        ** The element which entered the window last.
+        */
+        constexpr decltype(auto) back() const
+        {
+            return *_last;
+        }
+
+        constexpr sliding_iterator &operator++()
+        {
+            ++_first;
+            ++_last;
+            return *this;
+        }
+
+        constexpr const sliding_iterator operator++(int)
+        {
+            auto tmp = *this;
+
+            ++*this;
+            return tmp;
+        }
+
+        template <bool RA = is_random_access, std::enable_if_t<RA, int> = 0>
+        constexpr sliding_iterator &operator--()
+        {
+            --_first;
+            --_last;
+            return *this;
+        }
+
+        template <bool RA = is_random_access, std::enable_if_t<RA, int> = 0>
+        constexpr const sliding_iterator operator--(int)
+        {
+            auto tmp = *this;
+
+            --*this;
+            return tmp;
+        }
+
+        template <bool RA = is_random_access, std::enable_if_t<RA, int> = 0>
+        constexpr sliding_iterator operator+(difference_type n) const
+        {
+            auto tmp = *this;
+
+            tmp += n;
+            return tmp;
+        }
+
+        template <bool RA = is_random_access, std::enable_if_t<RA, int> = 0>
+        constexpr sliding_iterator &operator+=(difference_type n)
+        {
+            _first += n;
+            _last += n;
+            return *this;
+        }
+
+        template <bool RA = is_random_access, std::enable_if_t<RA, int> = 0>
+        constexpr sliding_iterator operator-(difference_type n) const
+        {
+            auto tmp = *this;
+
+            tmp -= n;
+            return tmp;
+        }
+
+        template <bool RA = is_random_access, std::enable_if_t<RA, int> = 0>
+        constexpr difference_type operator-(const sliding_iterator &other) const
+        {
+            return _last - other._last;
+        }
+
+        template <bool RA = is_random_access, std::enable_if_t<RA, int> = 0>
+        constexpr sliding_iterator &operator-=(difference_type n)
+        {
+            return *this += -n;
+        }
+
+        constexpr const iterator_type &base() const noexcept
+        {
+            return _first;
+        }
+
+        constexpr const iterator_type &last() const noexcept
+        {
+            return _last;
+        }
+
+        constexpr const std::size_t &size() const noexcept
+        {
+            return _size;
+        }
+
+    private:
+        Iter _first;
+        Iter _last;
+        std::size_t _size;
+    };
+
+    template <typename Iter, typename Sentinel>
+    inline constexpr bool operator==(const sliding_iterator<Iter, Sentinel> &lhs, const sliding_iterator<Iter, Sentinel> &rhs)
+    {
+        return lhs.last() == rhs.last();
+    }
+
+    template <typename Iter, typename Sentinel>
+    inline constexpr bool operator!=(const sliding_iterator<Iter, Sentinel> &lhs, const sliding_iterator<Iter, Sentinel> &rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+    template <typename Iter, typename Sentinel>
+    inline constexpr bool operator<(const sliding_iterator<Iter, Sentinel> &lhs, const sliding_iterator<Iter, Sentinel> &rhs)
+    {
+        return lhs.last() < rhs.last();
+    }
+
+    template <typename Iter, typename Sentinel>
+    inline constexpr bool operator>(const sliding_iterator<Iter, Sentinel> &lhs, const sliding_iterator<Iter, Sentinel> &rhs)
+    {
+        return rhs < lhs;
+    }
+
+    template <typename Iter, typename Sentinel>
+    inline constexpr bool operator<=(const sliding_iterator<Iter, Sentinel> &lhs, const sliding_iterator<Iter, Sentinel> &rhs)
+    {
+        return !(rhs < lhs);
+    }
+
+    template <typename Iter, typename Sentinel>
+    inline constexpr bool operator>=(const sliding_iterator<Iter, Sentinel> &lhs, const sliding_iterator<Iter, Sentinel> &rhs)
+    {
+        return !(lhs < rhs);
+    }
+
+    /*
+    ** The range is over once the last element of the window reaches the end of the base.
+    */
+    template <typename Iter, typename Sentinel, typename BaseSentinel>
+    inline constexpr bool operator==(const sliding_iterator<Iter, Sentinel> &lhs, const adaptor_sentinel<BaseSentinel> &rhs)
+    {
+        return lhs.last() == rhs.base();
+    }
+
+    template <typename Iter, typename Sentinel, typename BaseSentinel>
+    inline constexpr bool operator==(const adaptor_sentinel<BaseSentinel> &lhs, const sliding_iterator<Iter, Sentinel> &rhs)
+    {
+        return rhs == lhs;
+    }
+
+    template <typename Iter, typename Sentinel, typename BaseSentinel>
+    inline constexpr bool operator!=(const sliding_iterator<Iter, Sentinel> &lhs, const adaptor_sentinel<BaseSentinel> &rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+    template <typename Iter, typename Sentinel, typename BaseSentinel>
+    inline constexpr bool operator!=(const adaptor_sentinel<BaseSentinel> &lhs, const sliding_iterator<Iter, Sentinel> &rhs)
+    {
+        return !(rhs == lhs);
+    }
+
+    /*
+    ** Input ranges cannot be read twice, so their last size elements are kept in a ring buffer.
+    ** Every element is written twice, size elements apart, so that the window always lies in one
+    ** contiguous slice of the buffer, whatever its position in the ring. The buffer is shared by
+    ** the copies of an iterator, like the position in the base is.
+    */
+    template <typename Iter, typename Sentinel = Iter>
+    class ring_sliding_iterator
+    {
+    public:
+        using iterator_type = Iter;
+        using sentinel_type = Sentinel;
+        using difference_type = typename std::iterator_traits<Iter>::difference_type;
+        using value_type = range<const typename std::iterator_traits<Iter>::value_type *>;
+        using reference = value_type;
+        using pointer = details::fake_ptr<value_type>;
+        using iterator_category = std::input_iterator_tag;
+
+    private:
+        using element_type = typename std::iterator_traits<Iter>::value_type;
+
+        struct ring
+        {
+            Iter iter;
+            Sentinel end;
+            std::size_t size;
+            std::vector<element_type> buffer;
+            std::size_t count = 0;
+
+            void push()
+            {
+                auto slot = count++ % size;
+
+                buffer[slot] = *iter;
+                buffer[slot + size] = buffer[slot];
+                ++iter;
+            }
+        };
+
+    public:
+        constexpr ring_sliding_iterator() noexcept = default;
+
+        ring_sliding_iterator(Iter first, Sentinel end, std::size_t size) :
+            _ring(std::make_shared<ring>(ring{std::move(first), std::move(end), size, std::vector<element_type>(size * 2)}))
+        {
+            while (_ring->count < size && _ring->iter != _ring->end) {
+                _ring->push();
+            }
+            if (_ring->count < size) {
+                _ring = nullptr;
+            }
+        }
+
+        reference operator*() const noexcept
+        {
+            auto first = _ring->buffer.data() + _ring->count % _ring->size;
+
+            return value_type(first, first + _ring->size);
+        }
+
+        pointer operator->() const noexcept
+        {
+            return pointer{**this};
+        }
+
+        decltype(auto) front() const noexcept
+        {
+            return *(**this).begin();
+        }
+
+        decltype(auto) back() const noexcept
+        {
+            return *((**this).end() - 1);
+        }
+
+        ring_sliding_iterator &operator++()
+        {
+            if (_ring->iter == _ring->end) {
+                _ring = nullptr;
+            } else {
+                _ring->push();
+            }
+            return *this;
+        }
+
+        void operator++(int)
+        {
+            ++*this;
+        }
+
+        bool operator==(const ring_sliding_iterator &other) const noexcept
+        {
+            return _ring == other._ring;
+        }
+
+        bool operator!=(const ring_sliding_iterator &other) const noexcept
+        {
+            return !(*this == other);
+        }
+
+    private:
+        std::shared_ptr<ring> _ring;
+    };
+
+    namespace details
+    {
+        template <typename Iter, typename Sentinel>
+        struct sentinel_traits<sliding_iterator<Iter, Sentinel>>
+        {
+            using type = adaptor_sentinel<sentinel_t<Iter>>;
+
+            static constexpr type make(const sliding_iterator<Iter, Sentinel> &it)
+            {
+                return type(make_sentinel(it.last()));
+            }
+        };
+    }
+
+    /*
+    ** Yields every window of size consecutive elements of container, as views for forward ranges
+    ** and as slices of a ring buffer for input ones. A range shorter than size has no window.
+    ** size must be positive.
+    */
+    template <typename Container>
+    inline constexpr auto sliding(Container &&container, std::size_t size)
+    {
+        assert(size > 0 && "sliding needs a positive size");
+
+        auto first = std::begin(std::forward<Container>(container));
+        auto last = std::end(std::forward<Container>(container));
+        using iterator = decltype(first);
+        using iterator_category = typename std::iterator_traits<iterator>::iterator_category;
+
+        if constexpr (!std::is_base_of_v<std::forward_iterator_tag, iterator_category>) {
+            using ring_iterator = ring_sliding_iterator<iterator, decltype(last)>;
+
+            return make_range(ring_iterator(first, last, size), ring_iterator());
+        } else if constexpr (details::is_common_v<iterator, decltype(last)> &&
+                             details::has_constant_jumps_v<iterator>) {
+            auto span = static_cast<std::size_t>(last - first);
+            auto windows = static_cast<decltype(last - first)>(span >= size ? span - size + 1 : 0);
+            auto back = first + static_cast<decltype(last - first)>(span >= size ? size - 1 : span);
+            auto begin = sliding_iterator<iterator, decltype(last)>(first, back, size);
+
+            return make_range(begin, begin + windows);
+        } else {
+            auto back = first;
+
+            for (std::size_t i = 1; i < size && back != last; ++i) {
+                ++back;
+            }
+
+            auto stop = details::make_sentinel(last);
+            using sliding = sliding_iterator<iterator, decltype(stop)>;
+
+            if constexpr (details::is_common_v<iterator, decltype(last)>) {
+                return make_range(sliding(first, back, size), sliding(last, last, size));
+            } else {
+                return make_range(sliding(first, back, size), adaptor_sentinel<decltype(stop)>(stop));
+            }
+        }
+    }
+
+    namespace details
+    {
+        struct sliding_maker
+        {
+            using smite_tag = range_maker_tag;
+
+            template <typename Range>
+            constexpr auto operator()(Range &&rng) const
+            {
+                return sliding(std::forward<Range>(rng), _size);
+            }
+
+            std::size_t _size;
+        };
+    }
+
+    inline constexpr auto make_sliding(std::size_t size)
+    {
+        assert(size > 0 && "sliding needs a positive size");
+        return details::sliding_maker{size};
+    }
+}
+
+#endif /* !SMITE_SLIDING_ITERATOR_HPP */
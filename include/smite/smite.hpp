@@ -6,10 +6,26 @@
 #define SMITE_SMITE_HPP
 
 #include <smite/range.hpp>
+#include <smite/null_terminated.hpp>
+#include <smite/mmap_records.hpp>
+#include <smite/read_blocks.hpp>
+#include <smite/cache_latest_iterator.hpp>
 #include <smite/transform_iterator.hpp>
 #include <smite/filter_iterator.hpp>
 #include <smite/enumerate_iterator.hpp>
 #include <smite/multistep_iterator.hpp>
+#include <smite/take_iterator.hpp>
+#include <smite/chunk_iterator.hpp>
+#include <smite/sliding_iterator.hpp>
+#include <smite/rolling_iterator.hpp>
+#include <smite/split_iterator.hpp>
+#include <smite/join_iterator.hpp>
+#include <smite/prefetch_iterator.hpp>
+#include <smite/interleave_chase_iterator.hpp>
 #include <smite/zip_iterator.hpp>
+#include <smite/for_each.hpp>
+#include <smite/reduce.hpp>
+#include <smite/collect.hpp>
+#include <smite/parallel.hpp>
 
 #endif /* !SMITE_SMITE_HPP */
@@ -0,0 +1,230 @@
+/*
+** Created by doom on 18/10/26.
+*/
+
+#ifndef SMITE_SPLIT_ITERATOR_HPP
+#define SMITE_SPLIT_ITERATOR_HPP
+
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <smite/range.hpp>
+#include <smite/details/fake_ptr.hpp>
+#include <smite/details/contiguous.hpp>
+
+namespace smite
+{
+    /*
+    ** Iterates over the pieces of a buffer of characters between delimiters, as string views into
+    ** the buffer. Delimiters are searched with std::char_traits::find, which is memchr for char,
+    ** and scans many bytes at once instead of comparing them one by one.
+    **
+    ** Like in split, a buffer holding n delimiters has n + 1 pieces, so empty buffers have an empty
+    ** piece. With Lines, a delimiter ending the buffer does not start another piece, and a '\r'
+    ** ending a piece is left out, so that CRLF files split as LF ones do.
+    */
+    template <typename CharT, bool Lines = false>
+    class split_iterator
+    {
+    public:
+        using char_type = CharT;
+        using difference_type = std::ptrdiff_t;
+        using value_type = std::basic_string_view<CharT>;
+        using reference = value_type;
+        using pointer = details::fake_ptr<value_type>;
+        using iterator_category = std::forward_iterator_tag;
+
+        /*
+        ** The end iterator of a buffer is the one built from last, last.
+        */
+        constexpr split_iterator(const CharT *first, const CharT *last, CharT delimiter) noexcept :
+            _first(first), _last(last), _delimiter(delimiter), _done(first == last && Lines)
+        {
+            _seek_next();
+        }
+
+        constexpr split_iterator(const split_iterator &) = default;
+
+        constexpr split_iterator(split_iterator &&) = default;
+
+        constexpr split_iterator &operator=(const split_iterator &) = default;
+
+        constexpr split_iterator &operator=(split_iterator &&) = default;
+
+        static constexpr split_iterator end_of(const CharT *last, CharT delimiter) noexcept
+        {
+            split_iterator it(last, last, delimiter);
+
+            it._done = true;
+            return it;
+        }
+
+        constexpr reference operator*() const noexcept
+        {
+            auto size = static_cast<std::size_t>(_next - _first);
+
+            if constexpr (Lines) {
+                if (size != 0 && _first[size - 1] == CharT('\r')) {
+                    --size;
+                }
+            }
+            return value_type(_first, size);
+        }
+
+        constexpr pointer operator->() const noexcept
+        {
+            return pointer{**this};
+        }
+
+        constexpr split_iterator &operator++() noexcept
+        {
+            if (_next == _last) {
+                _first = _last;
+                _done = true;
+                return *this;
+            }
+            _first = _next + 1;
+            _done = Lines && _first == _last;
+            _seek_next();
+            return *this;
+        }
+
+        constexpr const split_iterator operator++(int) noexcept
+        {
+            auto tmp = *this;
+
+            ++*this;
+            return tmp;
+        }
+
+        constexpr bool operator==(const split_iterator &other) const noexcept
+        {
+            return _done == other._done && (_done || _first == other._first);
+        }
+
+        constexpr bool operator!=(const split_iterator &other) const noexcept
+        {
+            return !(*this == other);
+        }
+
+        constexpr const CharT *base() const noexcept
+        {
+            return _first;
+        }
+
+    private:
+        constexpr void _seek_next() noexcept
+        {
+            auto found = std::char_traits<CharT>::find(_first, static_cast<std::size_t>(_last - _first), _delimiter);
+
+            _next = found != nullptr ? found : _last;
+        }
+
+        const CharT *_first;
+        const CharT *_next = nullptr;
+        const CharT *_last;
+        CharT _delimiter;
+        bool _done;
+    };
+
+    namespace details
+    {
+        template <typename Container>
+        using char_type_t = std::remove_cv_t<std::remove_reference_t<decltype(*std::begin(std::declval<Container &>()))>>;
+
+        /*
+        ** Strings, string views and character literals are seen through a string view, which stops
+        ** literals before their terminating null. Other buffers must be contiguous.
+        */
+        template <typename CharT, typename Container>
+        inline constexpr auto char_pointers(const Container &container) noexcept
+        {
+            if constexpr (std::is_convertible_v<const Container &, std::basic_string_view<CharT>>) {
+                std::basic_string_view<CharT> view(container);
+
+                return std::pair<const CharT *, const CharT *>{view.data(), view.data() + view.size()};
+            } else {
+                using iterator = decltype(std::begin(container));
+
+                static_assert(is_contiguous_iterator_v<iterator>, "split needs a contiguous buffer");
+                auto [first, last] = to_pointers(std::begin(container), std::end(container));
+
+                return std::pair<const CharT *, const CharT *>{first, last};
+            }
+        }
+
+        template <bool Lines, typename CharT, typename Container>
+        inline constexpr auto make_split_range(const Container &container, CharT delimiter) noexcept
+        {
+            auto [first, last] = char_pointers<CharT>(container);
+            using iterator = split_iterator<CharT, Lines>;
+
+            return make_range(iterator(first, last, delimiter), iterator::end_of(last, delimiter));
+        }
+    }
+
+    /*
+    ** Splits a buffer of characters around every delimiter, into string views which copy nothing.
+    ** The buffer must outlive the pieces.
+    */
+    template <typename Container, typename CharT>
+    inline constexpr auto split(const Container &container, CharT delimiter) noexcept
+    {
+        return details::make_split_range<false>(container, delimiter);
+    }
+
+    /*
+    ** Splits a buffer of characters into its lines, without their line breaks.
+    */
+    template <typename Container>
+    inline constexpr auto lines(const Container &container) noexcept
+    {
+        using char_type = details::char_type_t<const Container>;
+
+        return details::make_split_range<true>(container, char_type('\n'));
+    }
+
+    namespace details
+    {
+        template <typename CharT>
+        struct split_maker
+        {
+            using smite_tag = range_maker_tag;
+
+            template <typename Range>
+            constexpr auto operator()(const Range &rng) const noexcept
+            {
+                return split(rng, _delimiter);
+            }
+
+            CharT _delimiter;
+        };
+
+        struct lines_maker
+        {
+            using smite_tag = range_maker_tag;
+
+            template <typename Range>
+            constexpr auto operator()(const Range &rng) const noexcept
+            {
+                return lines(rng);
+            }
+        };
+    }
+
+    template <typename CharT>
+    inline constexpr auto make_split(CharT delimiter) noexcept
+    {
+        return details::split_maker<CharT>{delimiter};
+    }
+
+    inline constexpr auto make_lines() noexcept
+    {
+        return details::lines_maker{};
+    }
+}
+
+#endif /* !SMITE_SPLIT_ITERATOR_HPP */
@@ -0,0 +1,289 @@
+/*
+** Created by doom on 18/10/26.
+*/
+
+#ifndef SMITE_TAKE_ITERATOR_HPP
+#define SMITE_TAKE_ITERATOR_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <iterator>
+#include <type_traits>
+#include <smite/range.hpp>
+#include <smite/details/push.hpp>
+
+namespace smite
+{
+    /*
+    ** Yields the first elements of its base, counting down how many are left. The base is not
+    ** incremented past the last element taken, so that nothing after it is read: a filter beneath
+    ** does not look for one more match, and an input source does not consume one more element.
+    */
+    template <typename Iter>
+    class take_iterator
+    {
+    public:
+        using iterator_type = Iter;
+
+    private:
+        using iterator_traits = std::iterator_traits<Iter>;
+
+    public:
+        using difference_type = typename iterator_traits::difference_type;
+        using value_type = typename iterator_traits::value_type;
+        using reference = typename iterator_traits::reference;
+        using pointer = typename iterator_traits::pointer;
+        using iterator_category = std::conditional_t<
+            std::is_base_of_v<std::forward_iterator_tag, typename iterator_traits::iterator_category>,
+            std::forward_iterator_tag,
+            std::input_iterator_tag
+        >;
+
+        constexpr take_iterator(Iter iter, difference_type count) : _base(std::move(iter)), _count(count)
+        {
+        }
+
+        constexpr take_iterator(const take_iterator &) = default;
+
+        constexpr take_iterator(take_iterator &&) = default;
+
+        constexpr take_iterator &operator=(const take_iterator &) = default;
+
+        constexpr take_iterator &operator=(take_iterator &&) = default;
+
+        constexpr reference operator*() const
+        {
+            return *_base;
+        }
+
+        constexpr pointer operator->() const
+        {
+            if constexpr (std::is_pointer_v<Iter>) {
+                return _base;
+            } else {
+                return _base.operator->();
+            }
+        }
+
+        constexpr take_iterator &operator++()
+        {
+            if (--_count != 0) {
+                ++_base;
+            }
+            return *this;
+        }
+
+        constexpr const take_iterator operator++(int)
+        {
+            auto tmp = *this;
+
+            ++*this;
+            return tmp;
+        }
+
+        constexpr const iterator_type &base() const noexcept
+        {
+            return _base;
+        }
+
+        /*
+        ** The number of elements left to take.
+        */
+        constexpr difference_type count() const noexcept
+        {
+            return _count;
+        }
+
+    private:
+        Iter _base;
+        difference_type _count;
+    };
+
+    /*
+    ** Iterators over the same range are at the same position when they have as many elements
+    ** left to take.
+    */
+    template <typename Iter>
+    inline constexpr bool operator==(const take_iterator<Iter> &lhs, const take_iterator<Iter> &rhs)
+    {
+        return lhs.count() == rhs.count();
+    }
+
+    template <typename Iter>
+    inline constexpr bool operator!=(const take_iterator<Iter> &lhs, const take_iterator<Iter> &rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+    template <typename Iter, typename BaseSentinel>
+    inline constexpr bool operator==(const take_iterator<Iter> &lhs, const adaptor_sentinel<BaseSentinel> &rhs)
+    {
+        return lhs.count() == 0 || lhs.base() == rhs.base();
+    }
+
+    template <typename Iter, typename BaseSentinel>
+    inline constexpr bool operator==(const adaptor_sentinel<BaseSentinel> &lhs, const take_iterator<Iter> &rhs)
+    {
+        return rhs == lhs;
+    }
+
+    template <typename Iter, typename BaseSentinel>
+    inline constexpr bool operator!=(const take_iterator<Iter> &lhs, const adaptor_sentinel<BaseSentinel> &rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+    template <typename Iter, typename BaseSentinel>
+    inline constexpr bool operator!=(const adaptor_sentinel<BaseSentinel> &lhs, const take_iterator<Iter> &rhs)
+    {
+        return !(rhs == lhs);
+    }
+
+    namespace details
+    {
+        /*
+        ** The base pushes its elements until the count runs out, which stops it like a sink would,
+        ** so that the loops of a filter or a join beneath end there too.
+        */
+        template <typename Iter>
+        struct push_traversal<take_iterator<Iter>>
+        {
+            static constexpr bool value = true;
+
+            template <typename Last, typename Sink>
+            static constexpr bool run(const take_iterator<Iter> &first, const Last &last, Sink &sink)
+            {
+                if constexpr (std::is_same_v<Last, take_iterator<Iter>>) {
+                    for (auto it = first; it != last; ++it) {
+                        if (sink(*it)) {
+                            return true;
+                        }
+                    }
+                    return false;
+                } else {
+                    auto count = first.count();
+                    bool stopped = false;
+
+                    if (count == 0) {
+                        return false;
+                    }
+                    for_each_until(first.base(), last.base(), [&count, &stopped, &sink](auto &&value) {
+                        stopped = sink(std::forward<decltype(value)>(value));
+                        return stopped || --count == 0;
+                    });
+                    return stopped;
+                }
+            }
+        };
+
+        template <typename Iter, typename Sentinel>
+        inline constexpr typename std::iterator_traits<Iter>::difference_type
+        clamp_count(const Iter &first, const Sentinel &last, std::size_t n)
+        {
+            using difference_type = typename std::iterator_traits<Iter>::difference_type;
+
+            return static_cast<difference_type>(std::min(static_cast<std::size_t>(last - first), n));
+        }
+    }
+
+    /*
+    ** The first n elements of container, or all of them when there are fewer. Common ranges with
+    ** constant-time jumps are cut in constant time into a range of the same iterators, everything
+    ** else is counted down along the way.
+    */
+    template <typename Container>
+    inline constexpr auto take(Container &&container, std::size_t n)
+    {
+        auto first = std::begin(std::forward<Container>(container));
+        auto last = std::end(std::forward<Container>(container));
+
+        if constexpr (details::is_common_v<decltype(first), decltype(last)> &&
+                      details::has_constant_jumps_v<decltype(first)>) {
+            return make_range(first, first + details::clamp_count(first, last, n));
+        } else {
+            using iterator = take_iterator<decltype(first)>;
+            auto stop = details::make_sentinel(last);
+
+            return make_range(iterator(first, static_cast<typename iterator::difference_type>(n)),
+                              adaptor_sentinel<decltype(stop)>(stop));
+        }
+    }
+
+    /*
+    ** All the elements of container but the first n. Common ranges with constant-time jumps skip
+    ** them in constant time, other ones are walked over once, when the range is made.
+    */
+    template <typename Container>
+    inline constexpr auto drop(Container &&container, std::size_t n)
+    {
+        auto first = std::begin(std::forward<Container>(container));
+        auto last = std::end(std::forward<Container>(container));
+
+        if constexpr (details::is_common_v<decltype(first), decltype(last)> &&
+                      details::has_constant_jumps_v<decltype(first)>) {
+            return make_range(first + details::clamp_count(first, last, n), last);
+        } else {
+            for (; n != 0 && first != last; --n) {
+                ++first;
+            }
+            return make_range(first, last);
+        }
+    }
+
+    namespace details
+    {
+        struct take_maker
+        {
+            using smite_tag = range_maker_tag;
+
+            template <typename Range>
+            constexpr auto operator()(Range &&rng) const
+            {
+                return take(std::forward<Range>(rng), _count);
+            }
+
+            std::size_t _count;
+        };
+
+        struct drop_maker
+        {
+            using smite_tag = range_maker_tag;
+
+            template <typename Range>
+            constexpr auto operator()(Range &&rng) const
+            {
+                return drop(std::forward<Range>(rng), _count);
+            }
+
+            std::size_t _count;
+        };
+
+        /*
+        ** Two takes in a row keep the shorter length, two drops skip both counts at once.
+        */
+        inline constexpr take_maker fuse(const take_maker &first, const take_maker &second) noexcept
+        {
+            return take_maker{std::min(first._count, second._count)};
+        }
+
+        inline constexpr drop_maker fuse(const drop_maker &first, const drop_maker &second) noexcept
+        {
+            auto count = first._count + second._count;
+
+            return drop_maker{count < first._count ? static_cast<std::size_t>(-1) : count};
+        }
+    }
+
+    inline constexpr auto make_take(std::size_t n)
+    {
+        return details::take_maker{n};
+    }
+
+    inline constexpr auto make_drop(std::size_t n)
+    {
+        return details::drop_maker{n};
+    }
+}
+
+#endif /* !SMITE_TAKE_ITERATOR_HPP */
@@ -8,6 +8,7 @@
 #include <utility>
 #include <iterator>
 #include <smite/range.hpp>
+#include <smite/details/push.hpp>
 #include <smite/details/fake_ptr.hpp>
 #include <smite/details/compressed_pair.hpp>
 
@@ -84,7 +85,7 @@ namespace smite
             return tmp;
         }
 
-        constexpr transform_iterator operator+(difference_type n)
+        constexpr transform_iterator operator+(difference_type n) const
         {
             return transform_iterator(base() + n, transformer());
         }
@@ -95,12 +96,12 @@ namespace smite
             return *this;
         }
 
-        constexpr transform_iterator operator-(difference_type n)
+        constexpr transform_iterator operator-(difference_type n) const
         {
             return transform_iterator(base() - n, transformer());
         }
 
-        constexpr difference_type operator-(transform_iterator other)
+        constexpr difference_type operator-(transform_iterator other) const
         {
             return std::distance(other.base(), base());
         }
@@ -174,6 +175,78 @@ namespace smite
         return !(lhs < rhs);
     }
 
+    template <typename Iter, typename Transformer, typename Sentinel>
+    inline constexpr bool operator==(const transform_iterator<Iter, Transformer> &lhs,
+                                     const adaptor_sentinel<Sentinel> &rhs)
+    {
+        return lhs.base() == rhs.base();
+    }
+
+    template <typename Iter, typename Transformer, typename Sentinel>
+    inline constexpr bool operator==(const adaptor_sentinel<Sentinel> &lhs,
+                                     const transform_iterator<Iter, Transformer> &rhs)
+    {
+        return rhs == lhs;
+    }
+
+    template <typename Iter, typename Transformer, typename Sentinel>
+    inline constexpr bool operator!=(const transform_iterator<Iter, Transformer> &lhs,
+                                     const adaptor_sentinel<Sentinel> &rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+    template <typename Iter, typename Transformer, typename Sentinel>
+    inline constexpr bool operator!=(const adaptor_sentinel<Sentinel> &lhs,
+                                     const transform_iterator<Iter, Transformer> &rhs)
+    {
+        return !(rhs == lhs);
+    }
+
+    template <typename Iter, typename Transformer, typename Sentinel>
+    inline constexpr auto operator-(const adaptor_sentinel<Sentinel> &lhs,
+                                    const transform_iterator<Iter, Transformer> &rhs) -> decltype(lhs.base() - rhs.base())
+    {
+        return lhs.base() - rhs.base();
+    }
+
+    template <typename Iter, typename Transformer, typename Sentinel>
+    inline constexpr auto operator-(const transform_iterator<Iter, Transformer> &lhs,
+                                    const adaptor_sentinel<Sentinel> &rhs) -> decltype(lhs.base() - rhs.base())
+    {
+        return lhs.base() - rhs.base();
+    }
+
+    namespace details
+    {
+        template <typename Iter, typename Transformer>
+        struct sentinel_traits<transform_iterator<Iter, Transformer>> :
+            adaptor_sentinel_traits<transform_iterator<Iter, Transformer>>
+        {
+        };
+
+        template <typename Iter, typename Transformer>
+        struct is_sized_iterator<transform_iterator<Iter, Transformer>> : is_sized_iterator<Iter>
+        {
+        };
+
+        template <typename Iter, typename Transformer>
+        struct push_traversal<transform_iterator<Iter, Transformer>>
+        {
+            static constexpr bool value = true;
+
+            template <typename Sentinel, typename Sink>
+            static constexpr bool run(const transform_iterator<Iter, Transformer> &first, const Sentinel &last, Sink &sink)
+            {
+                const auto &transformer = first.transformer();
+
+                return for_each_until(first.base(), last.base(), [&transformer, &sink](auto &&value) {
+                    return sink(transformer(std::forward<decltype(value)>(value)));
+                });
+            }
+        };
+    }
+
     template <typename Iter, typename Transformer>
     inline constexpr auto make_transform_iterator(Iter iter, Transformer &&transformer)
     {
@@ -185,8 +258,14 @@ namespace smite
     template <typename Container, typename Transformer>
     inline constexpr auto transform(Container &&container, Transformer &&transformer)
     {
-        return make_range(make_transform_iterator(std::begin(std::forward<Container>(container)), transformer),
-                          make_transform_iterator(std::end(std::forward<Container>(container)), transformer));
+        auto first = std::begin(std::forward<Container>(container));
+        auto last = std::end(std::forward<Container>(container));
+
+        if constexpr (details::is_common_v<decltype(first), decltype(last)>) {
+            return make_range(make_transform_iterator(first, transformer), make_transform_iterator(last, transformer));
+        } else {
+            return make_range(make_transform_iterator(first, transformer), adaptor_sentinel<decltype(last)>(last));
+        }
     }
 
     namespace details
@@ -211,6 +290,39 @@ namespace smite
     {
         return details::transform_maker<std::decay_t<Transformer>>{std::forward<Transformer>(transformer)};
     }
+
+    namespace details
+    {
+        template <typename First, typename Second>
+        struct composed_transformer : private compressed_pair<First, Second>
+        {
+        private:
+            using base_type = compressed_pair<First, Second>;
+
+        public:
+            constexpr composed_transformer(First first, Second second) : base_type(std::move(first), std::move(second))
+            {
+            }
+
+            template <typename T>
+            constexpr auto operator()(T &&value) const
+                -> decltype(std::declval<const Second &>()(std::declval<const First &>()(std::forward<T>(value))))
+            {
+                return base_type::second()(base_type::first()(std::forward<T>(value)));
+            }
+        };
+
+        /*
+        ** Two transforms in a row become a single transform calling g(f(x)).
+        */
+        template <typename First, typename Second>
+        inline constexpr auto fuse(const transform_maker<First> &first, const transform_maker<Second> &second)
+        {
+            using transformer_type = composed_transformer<First, Second>;
+
+            return transform_maker<transformer_type>{transformer_type(first._transformer, second._transformer)};
+        }
+    }
 }
 
 #endif /* !SMITE_TRANSFORM_ITERATOR_HPP */
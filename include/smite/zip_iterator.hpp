@@ -5,10 +5,13 @@
 #ifndef SMITE_ZIP_ITERATOR_HPP
 #define SMITE_ZIP_ITERATOR_HPP
 
+#include <algorithm>
 #include <iterator>
+#include <tuple>
 #include <smite/range.hpp>
 #include <smite/details/fake_ptr.hpp>
 #include <smite/details/compressed_pair.hpp>
+#include <smite/details/compressed_tuple.hpp>
 
 namespace smite
 {
@@ -28,35 +31,120 @@ namespace smite
 
         std::random_access_iterator_tag simplest_iterator_category(std::random_access_iterator_tag,
                                                                    std::random_access_iterator_tag);
+
+        template <typename Category, typename ...Categories>
+        struct simplest_category
+        {
+            using type = Category;
+        };
+
+        template <typename Category1, typename Category2, typename ...Categories>
+        struct simplest_category<Category1, Category2, Categories...> : simplest_category<
+            decltype(simplest_iterator_category(Category1{}, Category2{})),
+            Categories...
+        >
+        {
+        };
+
+        template <typename ...Iters>
+        using zip_category_t = typename simplest_category<
+            typename std::iterator_traits<Iters>::iterator_category...
+        >::type;
+
+        template <std::size_t I, typename ...Ts>
+        using nth_type_or_void_t = std::tuple_element_t<I, std::tuple<Ts..., void, void>>;
+
+        struct zip_no_index
+        {
+        };
     }
 
-    template <typename Iter1, typename Iter2>
+    template <typename ...Refs>
+    class zip_reference : public std::tuple<Refs...>
+    {
+    private:
+        using base_type = std::tuple<Refs...>;
+
+    public:
+        constexpr zip_reference(Refs ...refs) : base_type(std::forward<Refs>(refs)...)
+        {
+        }
+
+        constexpr zip_reference(const zip_reference &) = default;
+
+        constexpr zip_reference(zip_reference &&) = default;
+
+        constexpr zip_reference &operator=(const zip_reference &) = default;
+
+        constexpr zip_reference &operator=(zip_reference &&) = default;
+
+        using base_type::operator=;
+
+        friend constexpr void swap(zip_reference lhs, zip_reference rhs)
+        {
+            lhs._swap(rhs, std::index_sequence_for<Refs...>{});
+        }
+
+    private:
+        template <std::size_t ...Is>
+        constexpr void _swap(zip_reference &other, std::index_sequence<Is...>)
+        {
+            using std::swap;
+
+            (swap(std::get<Is>(*this), std::get<Is>(other)), ...);
+        }
+    };
+
+    template <typename ...Iters>
     class zip_iterator :
-        private details::compressed_pair<Iter1, Iter2>
+        private details::compressed_pair<
+            details::compressed_tuple<Iters...>,
+            std::conditional_t<
+                (details::has_constant_jumps_v<Iters> && ...),
+                typename std::iterator_traits<details::nth_type_or_void_t<0, Iters...>>::difference_type,
+                details::zip_no_index
+            >
+        >
     {
+        static_assert(sizeof...(Iters) > 0, "zip_iterator needs at least one iterator");
+
     public:
-        using first_iterator_type = Iter1;
-        using second_iterator_type = Iter2;
+        using first_iterator_type = details::nth_type_or_void_t<0, Iters...>;
+        using second_iterator_type = details::nth_type_or_void_t<1, Iters...>;
+
+        template <std::size_t I>
+        using nth_iterator_type = std::tuple_element_t<I, std::tuple<Iters...>>;
+
+        using iterators_type = details::compressed_tuple<Iters...>;
 
     private:
-        using base_type = details::compressed_pair<Iter1, Iter2>;
-        using first_iterator_traits = std::iterator_traits<Iter1>;
-        using second_iterator_traits = std::iterator_traits<Iter2>;
+        using first_iterator_traits = std::iterator_traits<first_iterator_type>;
+        using indices = std::index_sequence_for<Iters...>;
 
     public:
         using difference_type = typename first_iterator_traits::difference_type;
-        using value_type = typename first_iterator_traits::value_type;
-        using reference = std::pair<
-            typename first_iterator_traits::reference,
-            typename second_iterator_traits::reference
-        >;
+        using value_type = std::tuple<typename std::iterator_traits<Iters>::value_type...>;
+        using reference = zip_reference<typename std::iterator_traits<Iters>::reference...>;
         using pointer = details::fake_ptr<reference>;
-        using iterator_category = decltype(details::simplest_iterator_category(
-            typename first_iterator_traits::iterator_category{},
-            typename second_iterator_traits::iterator_category{}
-        ));
+        using iterator_category = details::zip_category_t<Iters...>;
 
-        constexpr zip_iterator(Iter1 iter, Iter2 iter2) : base_type(iter, iter2)
+        /*
+        ** When every base iterator moves in constant time, the bases stay where they started and
+        ** a single shared index is moved instead of every one of them.
+        */
+        static constexpr bool is_indexed = (details::has_constant_jumps_v<Iters> && ...);
+
+    private:
+        using index_type = std::conditional_t<is_indexed, difference_type, details::zip_no_index>;
+        using base_type = details::compressed_pair<iterators_type, index_type>;
+
+    public:
+        constexpr zip_iterator(Iters ...iters) : base_type(iterators_type(iters...), index_type())
+        {
+        }
+
+        template <bool Indexed = is_indexed, typename = std::enable_if_t<Indexed>>
+        constexpr zip_iterator(iterators_type iters, difference_type index) : base_type(iters, index)
         {
         }
 
@@ -75,13 +163,21 @@ namespace smite
 
         constexpr reference operator*() const
         {
-            return reference{*first_base(), *second_base()};
+            return _dereference(indices{});
+        }
+
+        constexpr reference operator[](difference_type n) const
+        {
+            return *(*this + n);
         }
 
         constexpr zip_iterator &operator++()
         {
-            ++first_base();
-            ++second_base();
+            if constexpr (is_indexed) {
+                ++_index();
+            } else {
+                _for_each_base([](auto &it) { ++it; }, indices{});
+            }
             return *this;
         }
 
@@ -95,8 +191,11 @@ namespace smite
 
         constexpr zip_iterator &operator--()
         {
-            --first_base();
-            --second_base();
+            if constexpr (is_indexed) {
+                --_index();
+            } else {
+                _for_each_base([](auto &it) { --it; }, indices{});
+            }
             return *this;
         }
 
@@ -108,111 +207,317 @@ namespace smite
             return tmp;
         }
 
-        constexpr zip_iterator operator+(difference_type n)
+        constexpr zip_iterator operator+(difference_type n) const
         {
-            return zip_iterator(first_base() + n, second_base() + n);
+            auto tmp = *this;
+
+            tmp += n;
+            return tmp;
         }
 
         constexpr zip_iterator &operator+=(difference_type n)
         {
-            first_base() += n;
-            second_base() += n;
+            if constexpr (is_indexed) {
+                _index() += n;
+            } else {
+                _for_each_base([n](auto &it) { std::advance(it, n); }, indices{});
+            }
             return *this;
         }
 
-        constexpr zip_iterator operator-(difference_type n)
+        constexpr zip_iterator operator-(difference_type n) const
         {
-            return zip_iterator(first_base() - n, second_base() - n);
+            auto tmp = *this;
+
+            tmp -= n;
+            return tmp;
         }
 
-        constexpr difference_type operator-(zip_iterator other)
+        constexpr difference_type operator-(const zip_iterator &other) const
         {
-            return std::distance(other.first_base(), first_base());
+            if constexpr (is_indexed) {
+                return index() - other.index();
+            } else {
+                if constexpr (std::is_same_v<iterator_category, std::random_access_iterator_tag>) {
+                    if (*this < other) {
+                        return -other._min_distance(*this, indices{});
+                    }
+                }
+                return _min_distance(other, indices{});
+            }
         }
 
         constexpr zip_iterator &operator-=(difference_type n)
         {
-            first_base() -= n;
-            second_base() -= n;
-            return *this;
+            return *this += -n;
         }
 
-        constexpr first_iterator_type &first_base() noexcept
+        template <std::size_t I>
+        constexpr nth_iterator_type<I> base() const
         {
-            return base_type::first();
+            if constexpr (is_indexed) {
+                return bases().template get<I>() + index();
+            } else {
+                return bases().template get<I>();
+            }
         }
 
-        constexpr const first_iterator_type &first_base() const noexcept
+        constexpr first_iterator_type first_base() const
+        {
+            return base<0>();
+        }
+
+        constexpr second_iterator_type second_base() const
+        {
+            return base<1>();
+        }
+
+        constexpr const iterators_type &bases() const noexcept
         {
             return base_type::first();
         }
 
-        constexpr second_iterator_type &second_base() noexcept
+        constexpr const index_type &index() const noexcept
         {
             return base_type::second();
         }
 
-        constexpr const second_iterator_type &second_base() const noexcept
+        template <typename Sentinels>
+        constexpr bool reached(const Sentinels &sentinels) const
+        {
+            return _reached(sentinels, indices{});
+        }
+
+        friend constexpr auto iter_move(const zip_iterator &it)
+        {
+            return it._move(indices{});
+        }
+
+        friend constexpr void iter_swap(const zip_iterator &lhs, const zip_iterator &rhs)
+        {
+            swap(*lhs, *rhs);
+        }
+
+    private:
+        constexpr iterators_type &_bases() noexcept
+        {
+            return base_type::first();
+        }
+
+        constexpr index_type &_index() noexcept
         {
             return base_type::second();
         }
+
+        template <std::size_t ...Is>
+        constexpr reference _dereference(std::index_sequence<Is...>) const
+        {
+            if constexpr (is_indexed) {
+                return reference{bases().template get<Is>()[index()]...};
+            } else {
+                return reference{*bases().template get<Is>()...};
+            }
+        }
+
+        template <std::size_t ...Is>
+        constexpr auto _move(std::index_sequence<Is...>) const
+        {
+            auto ref = **this;
+
+            return std::tuple<decltype(std::move(std::get<Is>(ref)))...>(std::move(std::get<Is>(ref))...);
+        }
+
+        template <typename F, std::size_t ...Is>
+        constexpr void _for_each_base(F &&f, std::index_sequence<Is...>)
+        {
+            (f(_bases().template get<Is>()), ...);
+        }
+
+        template <typename Sentinels, std::size_t ...Is>
+        constexpr bool _reached(const Sentinels &sentinels, std::index_sequence<Is...>) const
+        {
+            if constexpr (is_indexed) {
+                return ((base<Is>() == sentinels.template get<Is>()) || ...);
+            } else {
+                return ((bases().template get<Is>() == sentinels.template get<Is>()) || ...);
+            }
+        }
+
+        /*
+        ** The bases are only walked forward, from those of other, which must not be ahead.
+        */
+        template <std::size_t ...Is>
+        constexpr difference_type _min_distance(const zip_iterator &other, std::index_sequence<Is...>) const
+        {
+            difference_type distances[] = {
+                static_cast<difference_type>(std::distance(other.bases().template get<Is>(), bases().template get<Is>()))...
+            };
+
+            return *std::min_element(std::begin(distances), std::end(distances));
+        }
     };
 
-    template <typename Iter1, typename Iter2>
-    inline constexpr bool operator==(const zip_iterator<Iter1, Iter2> &lhs, const zip_iterator<Iter1, Iter2> &rhs)
+    /*
+    ** Two zip iterators compare equal as soon as one of their bases do, so that zipping ranges of
+    ** different lengths stops at the end of the shortest one.
+    */
+    template <typename ...Iters>
+    inline constexpr bool operator==(const zip_iterator<Iters...> &lhs, const zip_iterator<Iters...> &rhs)
     {
-        return lhs.first_base() == rhs.first_base() && lhs.second_base() == rhs.second_base();
+        if constexpr (zip_iterator<Iters...>::is_indexed) {
+            return lhs.index() == rhs.index();
+        } else {
+            return lhs.reached(rhs.bases());
+        }
     }
 
-    template <typename Iter1, typename Iter2>
-    inline constexpr bool operator!=(const zip_iterator<Iter1, Iter2> &lhs, const zip_iterator<Iter1, Iter2> &rhs)
+    template <typename ...Iters>
+    inline constexpr bool operator!=(const zip_iterator<Iters...> &lhs, const zip_iterator<Iters...> &rhs)
     {
         return !(rhs == lhs);
     }
 
-    template <typename Iter1, typename Iter2>
-    inline constexpr bool operator<(const zip_iterator<Iter1, Iter2> &lhs, const zip_iterator<Iter1, Iter2> &rhs)
+    template <typename ...Iters>
+    inline constexpr bool operator<(const zip_iterator<Iters...> &lhs, const zip_iterator<Iters...> &rhs)
     {
-        return lhs.first_base() < rhs.first_base() && lhs.second_base() < rhs.second_base();
+        if constexpr (zip_iterator<Iters...>::is_indexed) {
+            return lhs.index() < rhs.index();
+        } else {
+            return lhs.bases().template get<0>() < rhs.bases().template get<0>();
+        }
     }
 
-    template <typename Iter1, typename Iter2>
-    inline constexpr bool operator>(const zip_iterator<Iter1, Iter2> &lhs, const zip_iterator<Iter1, Iter2> &rhs)
+    template <typename ...Iters>
+    inline constexpr bool operator>(const zip_iterator<Iters...> &lhs, const zip_iterator<Iters...> &rhs)
     {
         return rhs < lhs;
     }
 
-    template <typename Iter1, typename Iter2>
-    inline constexpr bool operator<=(const zip_iterator<Iter1, Iter2> &lhs, const zip_iterator<Iter1, Iter2> &rhs)
+    template <typename ...Iters>
+    inline constexpr bool operator<=(const zip_iterator<Iters...> &lhs, const zip_iterator<Iters...> &rhs)
     {
         return !(rhs < lhs);
     }
 
-    template <typename Iter1, typename Iter2>
-    inline constexpr bool operator>=(const zip_iterator<Iter1, Iter2> &lhs, const zip_iterator<Iter1, Iter2> &rhs)
+    template <typename ...Iters>
+    inline constexpr bool operator>=(const zip_iterator<Iters...> &lhs, const zip_iterator<Iters...> &rhs)
     {
         return !(lhs < rhs);
     }
 
-    template <typename Iter1, typename Iter2>
-    inline constexpr auto make_zip_iterator(Iter1 iter, Iter2 &&iter2)
+    template <typename ...Iters>
+    inline constexpr zip_iterator<Iters...>
+    operator+(typename zip_iterator<Iters...>::difference_type n, const zip_iterator<Iters...> &it)
+    {
+        return it + n;
+    }
+
+    template <typename ...Iters, typename ...Sentinels>
+    inline constexpr bool operator==(const zip_iterator<Iters...> &lhs,
+                                     const adaptor_sentinel<details::compressed_tuple<Sentinels...>> &rhs)
+    {
+        return lhs.reached(rhs.base());
+    }
+
+    template <typename ...Iters, typename ...Sentinels>
+    inline constexpr bool operator==(const adaptor_sentinel<details::compressed_tuple<Sentinels...>> &lhs,
+                                     const zip_iterator<Iters...> &rhs)
     {
-        return zip_iterator<Iter1, Iter2>(iter, iter2);
+        return rhs == lhs;
+    }
+
+    template <typename ...Iters, typename ...Sentinels>
+    inline constexpr bool operator!=(const zip_iterator<Iters...> &lhs,
+                                     const adaptor_sentinel<details::compressed_tuple<Sentinels...>> &rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+    template <typename ...Iters, typename ...Sentinels>
+    inline constexpr bool operator!=(const adaptor_sentinel<details::compressed_tuple<Sentinels...>> &lhs,
+                                     const zip_iterator<Iters...> &rhs)
+    {
+        return !(rhs == lhs);
+    }
+
+    template <typename ...Iters>
+    inline constexpr auto make_zip_iterator(Iters ...iters)
+    {
+        return zip_iterator<Iters...>(iters...);
     }
 
     namespace details
     {
+        template <typename ...Iters>
+        struct sentinel_traits<zip_iterator<Iters...>>
+        {
+            using type = std::conditional_t<
+                zip_iterator<Iters...>::is_indexed,
+                zip_iterator<Iters...>,
+                adaptor_sentinel<compressed_tuple<sentinel_t<Iters>...>>
+            >;
+
+            static constexpr type make(const zip_iterator<Iters...> &it)
+            {
+                if constexpr (zip_iterator<Iters...>::is_indexed) {
+                    return it;
+                } else {
+                    return _make(it, std::index_sequence_for<Iters...>{});
+                }
+            }
+
+        private:
+            template <std::size_t ...Is>
+            static constexpr type _make(const zip_iterator<Iters...> &it, std::index_sequence<Is...>)
+            {
+                using tuple_type = typename type::sentinel_type;
+
+                return type(tuple_type(make_sentinel(it.template base<Is>())...));
+            }
+        };
+
+        template <typename ...Iters>
+        struct is_sized_iterator<zip_iterator<Iters...>> : std::conjunction<is_sized_iterator<Iters>...>
+        {
+        };
+
+        template <typename ...Sentinels>
+        inline constexpr auto make_zip_sentinel(const Sentinels &...sentinels)
+        {
+            using tuple_type = compressed_tuple<sentinel_t<Sentinels>...>;
+
+            return adaptor_sentinel<tuple_type>(tuple_type(make_sentinel(sentinels)...));
+        }
+
         struct zipper
         {
             using smite_tag = range_maker_tag;
 
-            template <typename Range1, typename Range2>
-            constexpr auto operator()(Range1 &&r1, Range2 &&r2) const
+            template <typename ...Ranges>
+            constexpr auto operator()(Ranges &&...rs) const
             {
-                return make_range(
-                    make_zip_iterator(std::begin(std::forward<Range1>(r1)), std::begin(std::forward<Range2>(r2))),
-                    make_zip_iterator(std::end(std::forward<Range1>(r1)), std::end(std::forward<Range2>(r2)))
-                );
+                using iterator = zip_iterator<decltype(std::begin(std::forward<Ranges>(rs)))...>;
+                constexpr bool is_common = (is_common_v<
+                    decltype(std::begin(std::forward<Ranges>(rs))),
+                    decltype(std::end(std::forward<Ranges>(rs)))
+                > && ...);
+
+                if constexpr (is_common && iterator::is_indexed) {
+                    typename iterator::difference_type size = std::min({
+                        static_cast<typename iterator::difference_type>(
+                            std::end(std::forward<Ranges>(rs)) - std::begin(std::forward<Ranges>(rs))
+                        )...
+                    });
+                    typename iterator::iterators_type firsts(std::begin(std::forward<Ranges>(rs))...);
+
+                    return make_range(iterator(firsts, 0), iterator(firsts, size));
+                } else if constexpr (is_common) {
+                    return make_range(iterator(std::begin(std::forward<Ranges>(rs))...),
+                                      iterator(std::end(std::forward<Ranges>(rs))...));
+                } else {
+                    return make_range(iterator(std::begin(std::forward<Ranges>(rs))...),
+                                      make_zip_sentinel(std::end(std::forward<Ranges>(rs))...));
+                }
             }
         };
     }
@@ -220,4 +525,17 @@ namespace smite
     inline constexpr details::zipper zip;
 }
 
+namespace std
+{
+    template <typename ...Refs>
+    struct tuple_size<smite::zip_reference<Refs...>> : std::integral_constant<std::size_t, sizeof...(Refs)>
+    {
+    };
+
+    template <std::size_t I, typename ...Refs>
+    struct tuple_element<I, smite::zip_reference<Refs...>> : std::tuple_element<I, std::tuple<Refs...>>
+    {
+    };
+}
+
 #endif /* !SMITE_ZIP_ITERATOR_HPP */
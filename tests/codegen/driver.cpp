@@ -0,0 +1,195 @@
+/*
+** Created by doom on 18/10/26.
+*/
+
+/*
+** Runs one pipeline of pipelines.cpp over n elements, for smite-codegen to trace. The inputs are
+** built first, then the process stops itself right before and right after the call, so that the
+** tracer counts the instructions of the call alone. "none" runs nothing between the two stops,
+** which measures what the stops themselves cost, and "check" runs both versions untraced and
+** fails when their results differ.
+**
+** Usage: driver <pipeline> <hand|smite|none|check> <n>
+*/
+
+#include <algorithm>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+using column = std::vector<std::int32_t>;
+using pages = std::vector<column>;
+
+extern "C"
+{
+    std::int64_t transform_hand(const column &c);
+    std::int64_t transform_smite(const column &c);
+    std::int64_t filter_hand(const column &c);
+    std::int64_t filter_smite(const column &c);
+    void zip_hand(column &out, const column &a, const column &b);
+    void zip_smite(column &out, const column &a, const column &b);
+    std::int64_t enumerate_hand(const column &c);
+    std::int64_t enumerate_smite(const column &c);
+    std::int64_t step_hand(const column &c);
+    std::int64_t step_smite(const column &c);
+    std::int64_t static_step_hand(const column &c);
+    std::int64_t static_step_smite(const column &c);
+    void deinterleave_hand(column &left, column &right, const column &stereo);
+    void deinterleave_smite(column &left, column &right, const column &stereo);
+    std::int64_t transform_filter_hand(const column &c);
+    std::int64_t transform_filter_smite(const column &c);
+    std::int64_t zip_transform_hand(const column &a, const column &b);
+    std::int64_t zip_transform_smite(const column &a, const column &b);
+    std::int64_t enumerate_step_hand(const column &c);
+    std::int64_t enumerate_step_smite(const column &c);
+    std::int64_t join_hand(const pages &p);
+    std::int64_t join_smite(const pages &p);
+    std::int64_t join_filter_hand(const pages &p);
+    std::int64_t join_filter_smite(const pages &p);
+    std::int64_t filter_even_hand(const column &c);
+    std::int64_t filter_even_smite(const column &c);
+    std::int64_t join_filter_even_hand(const pages &p);
+    std::int64_t join_filter_even_smite(const pages &p);
+}
+
+namespace
+{
+    struct inputs
+    {
+        explicit inputs(std::size_t n) : a(n), b(n), out(n), left(n), right(n), stereo(2 * n)
+        {
+            for (std::size_t i = 0; i < n; ++i) {
+                a[i] = static_cast<std::int32_t>(i * 7919 % 2003) - 1000;
+                b[i] = static_cast<std::int32_t>(i * 104729 % 4001) - 2000;
+            }
+            std::iota(stereo.begin(), stereo.end(), -static_cast<std::int32_t>(n));
+            for (std::size_t i = 0; i < n; i += segments.back().size()) {
+                segments.emplace_back(a.begin() + i, a.begin() + std::min(n, i + 1 + i % 97));
+            }
+        }
+
+        /*
+        ** Folds everything a pipeline may have produced, so that two runs can be compared.
+        */
+        std::int64_t checksum() const
+        {
+            std::int64_t sum = result;
+
+            for (const auto *c : {&out, &left, &right}) {
+                sum = std::accumulate(c->begin(), c->end(), sum);
+            }
+            return sum;
+        }
+
+        void reset()
+        {
+            result = 0;
+            for (auto *c : {&out, &left, &right}) {
+                std::fill(c->begin(), c->end(), 0);
+            }
+        }
+
+        column a;
+        column b;
+        column out;
+        column left;
+        column right;
+        column stereo;
+        pages segments = {column{}};
+        std::int64_t result = 0;
+    };
+
+    using runner = void (*)(inputs &);
+
+    struct pipeline
+    {
+        const char *name;
+        runner hand;
+        runner smite;
+    };
+
+    const pipeline pipelines[] = {
+        {"transform",        [](inputs &in) { in.result = transform_hand(in.a); },
+                             [](inputs &in) { in.result = transform_smite(in.a); }},
+        {"filter",           [](inputs &in) { in.result = filter_hand(in.a); },
+                             [](inputs &in) { in.result = filter_smite(in.a); }},
+        {"zip",              [](inputs &in) { zip_hand(in.out, in.a, in.b); },
+                             [](inputs &in) { zip_smite(in.out, in.a, in.b); }},
+        {"enumerate",        [](inputs &in) { in.result = enumerate_hand(in.a); },
+                             [](inputs &in) { in.result = enumerate_smite(in.a); }},
+        {"step",             [](inputs &in) { in.result = step_hand(in.a); },
+                             [](inputs &in) { in.result = step_smite(in.a); }},
+        {"static_step",      [](inputs &in) { in.result = static_step_hand(in.a); },
+                             [](inputs &in) { in.result = static_step_smite(in.a); }},
+        {"deinterleave",     [](inputs &in) { deinterleave_hand(in.left, in.right, in.stereo); },
+                             [](inputs &in) { deinterleave_smite(in.left, in.right, in.stereo); }},
+        {"transform_filter", [](inputs &in) { in.result = transform_filter_hand(in.a); },
+                             [](inputs &in) { in.result = transform_filter_smite(in.a); }},
+        {"zip_transform",    [](inputs &in) { in.result = zip_transform_hand(in.a, in.b); },
+                             [](inputs &in) { in.result = zip_transform_smite(in.a, in.b); }},
+        {"enumerate_step",   [](inputs &in) { in.result = enumerate_step_hand(in.a); },
+                             [](inputs &in) { in.result = enumerate_step_smite(in.a); }},
+        {"join",             [](inputs &in) { in.result = join_hand(in.segments); },
+                             [](inputs &in) { in.result = join_smite(in.segments); }},
+        {"join_filter",      [](inputs &in) { in.result = join_filter_hand(in.segments); },
+                             [](inputs &in) { in.result = join_filter_smite(in.segments); }},
+        {"filter_even",      [](inputs &in) { in.result = filter_even_hand(in.a); },
+                             [](inputs &in) { in.result = filter_even_smite(in.a); }},
+        {"join_filter_even", [](inputs &in) { in.result = join_filter_even_hand(in.segments); },
+                             [](inputs &in) { in.result = join_filter_even_smite(in.segments); }},
+    };
+}
+
+int main(int ac, char **av)
+{
+    if (ac != 4) {
+        std::cerr << "usage: " << av[0] << " <pipeline> <hand|smite|none|check> <n>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const pipeline *p = nullptr;
+
+    for (const auto &candidate : pipelines) {
+        if (std::strcmp(candidate.name, av[1]) == 0) {
+            p = &candidate;
+        }
+    }
+    if (p == nullptr) {
+        std::cerr << "unknown pipeline: " << av[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::string variant(av[2]);
+    inputs in(std::strtoul(av[3], nullptr, 10));
+
+    if (variant == "check") {
+        p->hand(in);
+        auto expected = in.checksum();
+
+        in.reset();
+        p->smite(in);
+        if (in.checksum() != expected) {
+            std::cerr << p->name << ": got " << in.checksum() << ", expected " << expected << std::endl;
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    runner run = variant == "hand" ? p->hand : variant == "smite" ? p->smite : nullptr;
+
+    if (run == nullptr && variant != "none") {
+        std::cerr << "unknown variant: " << variant << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::raise(SIGSTOP);
+    if (run != nullptr) {
+        run(in);
+    }
+    std::raise(SIGSTOP);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,312 @@
+/*
+** Created by doom on 18/10/26.
+*/
+
+/*
+** Canonical pipelines, each next to the loop one would write by hand instead. The codegen check
+** compiles this file to assembly and compares the code generated for every <name>_smite function
+** with the one generated for <name>_hand, then runs both through driver.cpp.
+**
+** Most filters keep positive elements. The parity filters keep even elements, a test which GCC
+** folds into single-bit operations on bool that it does not vectorize when they come out of a
+** callable: they check that smite widens predicate results so that its loops still vectorize.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <smite/smite.hpp>
+
+using column = std::vector<std::int32_t>;
+using pages = std::vector<column>;
+
+namespace
+{
+    constexpr auto triple = [](std::int32_t i) {
+        return i * 3;
+    };
+
+    constexpr auto is_positive = [](std::int32_t i) {
+        return i > 0;
+    };
+
+    constexpr auto is_even = [](std::int32_t i) {
+        return i % 2 == 0;
+    };
+}
+
+extern "C"
+{
+    std::int64_t transform_hand(const column &c)
+    {
+        std::int64_t sum = 0;
+
+        for (std::size_t i = 0; i < c.size(); ++i) {
+            sum += c[i] * 3;
+        }
+        return sum;
+    }
+
+    std::int64_t transform_smite(const column &c)
+    {
+        std::int64_t sum = 0;
+
+        for (auto i : smite::transform(c, triple)) {
+            sum += i;
+        }
+        return sum;
+    }
+
+    std::int64_t filter_hand(const column &c)
+    {
+        std::int64_t sum = 0;
+
+        for (std::size_t i = 0; i < c.size(); ++i) {
+            if (c[i] > 0) {
+                sum += c[i];
+            }
+        }
+        return sum;
+    }
+
+    std::int64_t filter_smite(const column &c)
+    {
+        std::int64_t sum = 0;
+
+        for (auto i : smite::filter(c, is_positive)) {
+            sum += i;
+        }
+        return sum;
+    }
+
+    void zip_hand(column &out, const column &a, const column &b)
+    {
+        auto n = std::min({out.size(), a.size(), b.size()});
+
+        for (std::size_t i = 0; i < n; ++i) {
+            out[i] = a[i] + b[i];
+        }
+    }
+
+    void zip_smite(column &out, const column &a, const column &b)
+    {
+        for (auto &&[o, x, y] : smite::zip(out, a, b)) {
+            o = x + y;
+        }
+    }
+
+    std::int64_t enumerate_hand(const column &c)
+    {
+        std::int64_t sum = 0;
+
+        for (std::size_t i = 0; i < c.size(); ++i) {
+            sum += static_cast<std::int64_t>(i) * c[i];
+        }
+        return sum;
+    }
+
+    std::int64_t enumerate_smite(const column &c)
+    {
+        std::int64_t sum = 0;
+
+        for (auto [i, value] : smite::enumerate(c)) {
+            sum += i * value;
+        }
+        return sum;
+    }
+
+    std::int64_t step_hand(const column &c)
+    {
+        std::int64_t sum = 0;
+
+        for (std::size_t i = 0; i < c.size(); i += 4) {
+            sum += c[i];
+        }
+        return sum;
+    }
+
+    std::int64_t step_smite(const column &c)
+    {
+        std::int64_t sum = 0;
+
+        for (auto i : smite::step(c, 4)) {
+            sum += i;
+        }
+        return sum;
+    }
+
+    std::int64_t static_step_hand(const column &c)
+    {
+        return step_hand(c);
+    }
+
+    std::int64_t static_step_smite(const column &c)
+    {
+        return smite::sum(smite::step<4>(c), std::int64_t{0});
+    }
+
+    void deinterleave_hand(column &left, column &right, const column &stereo)
+    {
+        auto n = std::min({left.size(), right.size(), stereo.size() / 2});
+
+        for (std::size_t i = 0; i < n; ++i) {
+            left[i] = stereo[2 * i];
+            right[i] = stereo[2 * i + 1];
+        }
+    }
+
+    void deinterleave_smite(column &left, column &right, const column &stereo)
+    {
+        auto odd = smite::make_range(stereo.begin() + 1, stereo.end());
+        auto channels = smite::zip(smite::step<2>(stereo), smite::step<2>(odd));
+
+        for (auto &&[l, r, sample] : smite::zip(left, right, channels)) {
+            l = std::get<0>(sample);
+            r = std::get<1>(sample);
+        }
+    }
+
+    std::int64_t transform_filter_hand(const column &c)
+    {
+        std::int64_t sum = 0;
+
+        for (std::size_t i = 0; i < c.size(); ++i) {
+            auto value = c[i] * 3;
+
+            if (value > 0) {
+                sum += value;
+            }
+        }
+        return sum;
+    }
+
+    std::int64_t transform_filter_smite(const column &c)
+    {
+        std::int64_t sum = 0;
+
+        for (auto i : smite::filter(smite::transform(c, triple), is_positive)) {
+            sum += i;
+        }
+        return sum;
+    }
+
+    std::int64_t zip_transform_hand(const column &a, const column &b)
+    {
+        auto n = std::min(a.size(), b.size());
+        std::int64_t sum = 0;
+
+        for (std::size_t i = 0; i < n; ++i) {
+            sum += a[i] * b[i];
+        }
+        return sum;
+    }
+
+    std::int64_t zip_transform_smite(const column &a, const column &b)
+    {
+        std::int64_t sum = 0;
+
+        for (auto product : smite::transform(smite::zip(a, b), [](auto &&pair) {
+            return std::get<0>(pair) * std::get<1>(pair);
+        })) {
+            sum += product;
+        }
+        return sum;
+    }
+
+    std::int64_t enumerate_step_hand(const column &c)
+    {
+        std::int64_t sum = 0;
+
+        for (std::size_t i = 0; i < c.size(); i += 2) {
+            sum += static_cast<std::int64_t>(i / 2) * c[i];
+        }
+        return sum;
+    }
+
+    std::int64_t enumerate_step_smite(const column &c)
+    {
+        std::int64_t sum = 0;
+
+        for (auto [i, value] : smite::enumerate(smite::step(c, 2))) {
+            sum += i * value;
+        }
+        return sum;
+    }
+
+    std::int64_t join_hand(const pages &p)
+    {
+        std::int64_t sum = 0;
+
+        for (const auto &page : p) {
+            for (std::size_t i = 0; i < page.size(); ++i) {
+                sum += page[i];
+            }
+        }
+        return sum;
+    }
+
+    std::int64_t join_smite(const pages &p)
+    {
+        return smite::sum(smite::join(p), std::int64_t{0});
+    }
+
+    std::int64_t join_filter_hand(const pages &p)
+    {
+        std::int64_t sum = 0;
+
+        for (const auto &page : p) {
+            for (std::size_t i = 0; i < page.size(); ++i) {
+                if (page[i] > 0) {
+                    sum += page[i];
+                }
+            }
+        }
+        return sum;
+    }
+
+    std::int64_t join_filter_smite(const pages &p)
+    {
+        return smite::sum(smite::filter(smite::join(p), is_positive), std::int64_t{0});
+    }
+
+    std::int64_t filter_even_hand(const column &c)
+    {
+        std::int64_t sum = 0;
+
+        for (std::size_t i = 0; i < c.size(); ++i) {
+            if (c[i] % 2 == 0) {
+                sum += c[i];
+            }
+        }
+        return sum;
+    }
+
+    std::int64_t filter_even_smite(const column &c)
+    {
+        std::int64_t sum = 0;
+
+        for (auto i : smite::filter(c, is_even)) {
+            sum += i;
+        }
+        return sum;
+    }
+
+    std::int64_t join_filter_even_hand(const pages &p)
+    {
+        std::int64_t sum = 0;
+
+        for (const auto &page : p) {
+            for (std::size_t i = 0; i < page.size(); ++i) {
+                if (page[i] % 2 == 0) {
+                    sum += page[i];
+                }
+            }
+        }
+        return sum;
+    }
+
+    std::int64_t join_filter_even_smite(const pages &p)
+    {
+        return smite::sum(smite::filter(smite::join(p), is_even), std::int64_t{0});
+    }
+}
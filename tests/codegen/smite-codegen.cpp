@@ -0,0 +1,439 @@
+/*
+** Created by doom on 18/10/26.
+*/
+
+/*
+** Checks that the code generated for every <name>_smite function of pipelines.cpp does not lose
+** against the one generated for <name>_hand. The assembly shows whether calls are left and
+** whether loops are vectorized: a smite loop must be whenever the hand-written one is. Then both
+** versions are run over the same elements, single-stepped by ptrace, and the instructions they
+** execute per element are compared, which accounts for unrolling, vector width and whatever runs
+** outside of the loops, unlike counting instructions in the assembly.
+**
+** Pipelines which are known to miss their expectations with the compiler at hand are listed
+** along with why, and reported as expected failures.
+**
+** Usage: smite-codegen <compiler> <pipelines.cpp> <driver.cpp> <include directory>
+*/
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <set>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <sys/ptrace.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace
+{
+    /*
+    ** How many times more instructions per element a smite version may execute than its
+    ** hand-written counterpart, which leaves room for loop setup only.
+    */
+    constexpr double max_ratio = 1.05;
+
+    const char *const pipelines[] = {
+        "transform",
+        "filter",
+        "zip",
+        "enumerate",
+        "step",
+        "static_step",
+        "deinterleave",
+        "transform_filter",
+        "zip_transform",
+        "enumerate_step",
+        "join",
+        "join_filter",
+        "filter_even",
+        "join_filter_even",
+    };
+
+    /*
+    ** Pipelines known to miss their expectations with a given compiler. Their failures are
+    ** reported but do not fail the check, and they fail it once they pass, so that the note
+    ** is removed along with the issue.
+    */
+    struct known_issue
+    {
+        const char *pipeline;
+        const char *note;
+    };
+
+    /*
+    ** The range-for loops over filters can only see kept elements one at a time, and the
+    ** batched filters walk the bits of their vectorized predicate results for that, while
+    ** compilers turn the hand-written loops into branchless sums of masked vectors, which only
+    ** works because they fold what they keep. Fixing that takes a pull path which hands the
+    ** loop body whole blocks.
+    */
+    constexpr const char *pull_filter_note = "range-for over a filter walks kept elements one at a time";
+
+    const known_issue gcc_known_issues[] = {
+        {"filter",           pull_filter_note},
+        {"transform_filter", pull_filter_note},
+        {"filter_even",      pull_filter_note},
+        {"deinterleave",     "GCC only groups strided loads sharing an induction variable, and zipped "
+                             "steps each keep their own, so every vector is loaded twice"},
+    };
+
+    /*
+    ** Not tuned against a Clang build yet: only the issues that do not depend on the compiler.
+    */
+    const known_issue clang_known_issues[] = {
+        {"filter",           pull_filter_note},
+        {"transform_filter", pull_filter_note},
+        {"filter_even",      pull_filter_note},
+    };
+
+    struct compiler_family
+    {
+        const char *name;
+        const known_issue *first;
+        const known_issue *last;
+    };
+
+    /*
+    ** An odd size, so that the tails after unrolled or vectorized loops run too.
+    */
+    constexpr std::size_t elements = 4099;
+
+    struct instruction
+    {
+        std::string mnemonic;
+        std::string operands;
+    };
+
+    struct function
+    {
+        std::vector<instruction> instructions;
+        std::unordered_map<std::string, std::size_t> labels;
+    };
+
+    struct report
+    {
+        std::size_t packed_loop_instructions = 0;
+        std::size_t calls = 0;
+        double per_element = 0;
+    };
+
+    std::optional<std::string> run(const std::string &command)
+    {
+        std::string output;
+        char buffer[4096];
+        auto pipe = popen(command.c_str(), "r");
+
+        if (pipe == nullptr) {
+            return std::nullopt;
+        }
+        while (auto n = std::fread(buffer, 1, sizeof(buffer), pipe)) {
+            output.append(buffer, n);
+        }
+        if (pclose(pipe) != 0) {
+            return std::nullopt;
+        }
+        return output;
+    }
+
+    std::string trim(const std::string &s)
+    {
+        auto first = s.find_first_not_of(" \t");
+        auto last = s.find_last_not_of(" \t");
+
+        return first == std::string::npos ? std::string{} : s.substr(first, last - first + 1);
+    }
+
+    /*
+    ** Splits the AT&T assembly emitted by GCC and Clang into functions, keeping their instructions
+    ** and the positions of their local labels.
+    */
+    std::unordered_map<std::string, function> parse(const std::string &assembly)
+    {
+        std::unordered_map<std::string, function> functions;
+        std::istringstream lines(assembly);
+        std::string line;
+        function *current = nullptr;
+
+        while (std::getline(lines, line)) {
+            auto comment = line.find('#');
+
+            if (comment != std::string::npos) {
+                line.erase(comment);
+            }
+            if (line.empty()) {
+                continue;
+            }
+            if (line[0] != '\t' && line[0] != ' ' && line.back() == ':') {
+                auto label = line.substr(0, line.size() - 1);
+
+                if (label[0] != '.') {
+                    current = &functions[label];
+                } else if (current != nullptr) {
+                    current->labels[label] = current->instructions.size();
+                }
+                continue;
+            }
+            line = trim(line);
+            if (current == nullptr || line.empty() || line[0] == '.') {
+                if (line == ".cfi_endproc") {
+                    current = nullptr;
+                }
+                continue;
+            }
+
+            auto space = line.find_first_of(" \t");
+
+            if (space == std::string::npos) {
+                current->instructions.push_back({line, {}});
+            } else {
+                current->instructions.push_back({line.substr(0, space), trim(line.substr(space))});
+            }
+        }
+        return functions;
+    }
+
+    bool is_packed(const instruction &i)
+    {
+        const auto &m = i.mnemonic;
+        auto uses_vectors = i.operands.find("mm") != std::string::npos;
+        auto ends_with = [&m](const char *suffix) {
+            std::string s(suffix);
+
+            return m.size() > s.size() && m.compare(m.size() - s.size(), s.size(), s) == 0;
+        };
+
+        if (!uses_vectors) {
+            return false;
+        }
+        return m[0] == 'p' || m.rfind("vp", 0) == 0 || m.find("dq") != std::string::npos ||
+               ends_with("ps") || ends_with("pd");
+    }
+
+    /*
+    ** Loops are found from their backward jumps.
+    */
+    report analyze(const function &f)
+    {
+        report r;
+        std::set<std::size_t> in_loops;
+
+        for (std::size_t i = 0; i < f.instructions.size(); ++i) {
+            const auto &ins = f.instructions[i];
+
+            if (ins.mnemonic.rfind("call", 0) == 0) {
+                ++r.calls;
+            }
+            if (ins.mnemonic[0] != 'j') {
+                continue;
+            }
+
+            auto target = f.labels.find(ins.operands);
+
+            if (target != f.labels.end() && target->second <= i) {
+                for (auto j = target->second; j <= i; ++j) {
+                    in_loops.insert(j);
+                }
+            } else if (ins.mnemonic == "jmp" && target == f.labels.end() && ins.operands[0] != '*') {
+                ++r.calls;
+            }
+        }
+        for (auto i : in_loops) {
+            r.packed_loop_instructions += is_packed(f.instructions[i]);
+        }
+        return r;
+    }
+
+    /*
+    ** Compilers other than GCC and Clang have no known issues, and are held to every
+    ** expectation.
+    */
+    compiler_family family_of(const std::string &compiler)
+    {
+        auto macros = run(compiler + " -dM -E -x c++ /dev/null");
+
+        if (macros && macros->find("#define __clang__ ") != std::string::npos) {
+            return {"Clang", std::begin(clang_known_issues), std::end(clang_known_issues)};
+        }
+        if (macros && macros->find("#define __GNUC__ ") != std::string::npos) {
+            return {"GCC", std::begin(gcc_known_issues), std::end(gcc_known_issues)};
+        }
+        return {"an unknown compiler", nullptr, nullptr};
+    }
+
+    const char *known_issue_of(const compiler_family &family, const std::string &pipeline)
+    {
+        for (auto it = family.first; it != family.last; ++it) {
+            if (pipeline == it->pipeline) {
+                return it->note;
+            }
+        }
+        return nullptr;
+    }
+
+    /*
+    ** Runs the driver over the given pipeline, and counts the instructions it executes between
+    ** the two points where it stops itself.
+    */
+    std::optional<std::size_t> count_instructions(const std::string &driver, const char *name, const char *variant)
+    {
+        auto n = std::to_string(elements);
+        auto pid = fork();
+
+        if (pid < 0) {
+            return std::nullopt;
+        }
+        if (pid == 0) {
+            ptrace(PTRACE_TRACEME, 0, nullptr, nullptr);
+            execl(driver.c_str(), driver.c_str(), name, variant, n.c_str(), static_cast<char *>(nullptr));
+            _exit(EXIT_FAILURE);
+        }
+
+        std::size_t count = 0;
+        int stops = 0;
+        int status = 0;
+
+        while (waitpid(pid, &status, 0) == pid && WIFSTOPPED(status)) {
+            if (WSTOPSIG(status) == SIGSTOP) {
+                ++stops;
+            } else if (stops == 1) {
+                ++count;
+            }
+            if (ptrace(stops == 1 ? PTRACE_SINGLESTEP : PTRACE_CONT, pid, nullptr, nullptr) != 0) {
+                kill(pid, SIGKILL);
+                waitpid(pid, &status, 0);
+                return std::nullopt;
+            }
+        }
+        if (stops != 2 || !WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+            return std::nullopt;
+        }
+        return count;
+    }
+
+    std::vector<std::string> check(const report &hand, const report &smite)
+    {
+        std::vector<std::string> failures;
+
+        if (smite.calls != 0) {
+            failures.push_back(std::to_string(smite.calls) + " calls left");
+        }
+        if (hand.packed_loop_instructions != 0 && smite.packed_loop_instructions == 0) {
+            failures.emplace_back("loop not vectorized, unlike by hand");
+        }
+        if (smite.per_element > max_ratio * hand.per_element) {
+            failures.push_back(std::to_string(smite.per_element) + " instructions per element, against " +
+                               std::to_string(hand.per_element) + " by hand");
+        }
+        return failures;
+    }
+
+    /*
+    ** Failures of pipelines with a known issue are expected, and their success is not.
+    */
+    bool judge(const std::string &pipeline, const char *known_issue, const std::vector<std::string> &failures)
+    {
+        if (known_issue == nullptr) {
+            for (const auto &why : failures) {
+                std::cerr << "FAIL " << pipeline << ": " << why << std::endl;
+            }
+            return failures.empty();
+        }
+        if (failures.empty()) {
+            std::cerr << "XPASS " << pipeline << ": passes despite its known issue, " << known_issue << std::endl;
+            return false;
+        }
+        for (const auto &why : failures) {
+            std::cerr << "XFAIL " << pipeline << ": " << why << " (" << known_issue << ")" << std::endl;
+        }
+        return true;
+    }
+}
+
+int main(int ac, char **av)
+{
+    if (ac != 5) {
+        std::cerr << "usage: " << av[0] << " <compiler> <pipelines.cpp> <driver.cpp> <include directory>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::string compiler(av[1]);
+    auto family = family_of(compiler);
+
+    std::printf("checking %s as %s\n", compiler.c_str(), family.name);
+
+    auto flags = std::string(" -std=c++17 -O3 -I") + av[4] + " ";
+    auto assembly = run(compiler + flags + "-S -o - " + av[2]);
+
+    if (!assembly) {
+        std::cerr << "failed to compile " << av[2] << " to assembly" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    char driver[] = "/tmp/smite-codegen-XXXXXX";
+    auto fd = mkstemp(driver);
+
+    if (fd < 0) {
+        std::cerr << "failed to create the driver" << std::endl;
+        return EXIT_FAILURE;
+    }
+    close(fd);
+    if (!run(compiler + flags + av[2] + " " + av[3] + " -o " + driver)) {
+        std::cerr << "failed to build the driver" << std::endl;
+        unlink(driver);
+        return EXIT_FAILURE;
+    }
+
+    auto functions = parse(*assembly);
+    auto baseline = count_instructions(driver, pipelines[0], "none");
+
+    if (!baseline) {
+        std::cerr << "failed to trace the driver" << std::endl;
+        unlink(driver);
+        return EXIT_FAILURE;
+    }
+
+    auto ok = true;
+
+    std::printf("%-18s %12s %12s %8s %8s %8s\n", "pipeline", "hand/elem", "smite/elem", "ratio", "packed", "calls");
+    for (const char *name : pipelines) {
+        auto hand = functions.find(std::string(name) + "_hand");
+        auto smite = functions.find(std::string(name) + "_smite");
+
+        if (hand == functions.end() || smite == functions.end()) {
+            std::cerr << "FAIL " << name << ": function not found" << std::endl;
+            ok = false;
+            continue;
+        }
+        if (!run(std::string(driver) + " " + name + " check " + std::to_string(elements))) {
+            std::cerr << "FAIL " << name << ": results differ from the hand-written version" << std::endl;
+            ok = false;
+            continue;
+        }
+
+        auto hand_report = analyze(hand->second);
+        auto smite_report = analyze(smite->second);
+        auto hand_count = count_instructions(driver, name, "hand");
+        auto smite_count = count_instructions(driver, name, "smite");
+
+        if (!hand_count || !smite_count) {
+            std::cerr << "FAIL " << name << ": failed to trace the driver" << std::endl;
+            ok = false;
+            continue;
+        }
+        hand_report.per_element = static_cast<double>(*hand_count - *baseline) / elements;
+        smite_report.per_element = static_cast<double>(*smite_count - *baseline) / elements;
+        std::printf("%-18s %12.2f %12.2f %8.2f %8zu %8zu\n", name, hand_report.per_element,
+                    smite_report.per_element, smite_report.per_element / hand_report.per_element,
+                    smite_report.packed_loop_instructions, smite_report.calls);
+        ok = judge(name, known_issue_of(family, name), check(hand_report, smite_report)) && ok;
+    }
+    unlink(driver);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -5,7 +5,21 @@
 #include <gtest/gtest.h>
 #include <vector>
 #include <list>
+#include <map>
+#include <unordered_set>
 #include <numeric>
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <sstream>
+#include <iterator>
+#include <atomic>
+#include <stdexcept>
+#include <cstdio>
+#include <system_error>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
 #include <smite/smite.hpp>
 #include <smite/details/compressed_pair.hpp>
 
@@ -231,6 +245,61 @@ TEST(smite, filter_iterator)
     static_assert(check_same_movability_v<iter, iter::iterator_type, iter::predicate_type>);
 }
 
+TEST(smite, cache_latest)
+{
+    std::vector<int> vec(10, 0);
+    std::size_t calls = 0;
+    auto decode = [&calls](int i) {
+        ++calls;
+        return std::to_string(i);
+    };
+    auto pred = [](const std::string &s) {
+        return s != "3";
+    };
+
+    std::iota(vec.begin(), vec.end(), 0);
+    auto uncached = smite::filter(smite::transform(vec, decode), pred);
+    std::vector<std::string> out;
+    for (const auto &s : uncached) {
+        out.push_back(s);
+    }
+    ASSERT_EQ(out.size(), 9u);
+    ASSERT_EQ(calls, vec.size() + out.size());
+
+    using namespace smite;
+    calls = 0;
+    auto rng = smite::filter(smite::transform(vec, decode) | cache_latest, pred);
+    out.clear();
+    for (const auto &s : rng) {
+        out.push_back(s);
+    }
+    ASSERT_EQ(out.size(), 9u);
+    ASSERT_EQ(out[3], "4");
+    ASSERT_EQ(calls, vec.size());
+
+    using iter = decltype(rng.begin())::iterator_type;
+    static_assert(std::is_same_v<iter::reference, std::string &>);
+    static_assert(std::is_same_v<iter::iterator_category, std::input_iterator_tag>);
+    static_assert(std::is_same_v<decltype(rng.begin())::iterator_category, std::input_iterator_tag>);
+
+    calls = 0;
+    auto cached = vec | make_transform(decode) | cache_latest;
+    auto it = cached.begin();
+    ASSERT_EQ(*it, "0");
+    ASSERT_EQ(it->size(), 1u);
+    ASSERT_EQ(calls, 1u);
+    ++it;
+    ASSERT_EQ(*it, "1");
+    ASSERT_EQ(calls, 2u);
+    it += 5;
+    ASSERT_EQ(*it, "6");
+    ASSERT_EQ(cached.end() - it, 4);
+    ASSERT_EQ(calls, 3u);
+
+    auto kept = smite::filter(vec, [](int i) { return i % 2 == 0; });
+    static_assert(std::is_same_v<decltype(kept.begin())::iterator_type, std::vector<int>::iterator>);
+}
+
 TEST(smite, zip_iterator)
 {
     std::vector<int> vec(5, 0);
@@ -253,7 +322,7 @@ TEST(smite, zip_iterator)
     using veciter_traits = std::iterator_traits<std::vector<int>::iterator>;
     static_assert(check_iterator_category_v<iter_traits, veciter_traits>);
     static_assert(check_difference_type_v<iter_traits, veciter_traits>);
-    static_assert(check_value_type_v<iter_traits, veciter_traits>);
+    static_assert(std::is_same_v<iter_traits::value_type, std::tuple<int, float>>);
     static_assert(check_same_triviality_v<iter, iter::first_iterator_type, iter::second_iterator_type>);
     static_assert(check_same_noexceptness_v<iter, iter::first_iterator_type, iter::second_iterator_type>);
     static_assert(check_same_copyability_v<iter, iter::first_iterator_type, iter::second_iterator_type>);
@@ -278,6 +347,51 @@ TEST(smite, combination)
     static_assert(smite::is_range_maker_v<decltype(take_index)>);
 }
 
+TEST(smite, fusion)
+{
+    using namespace smite;
+    std::vector<int> in(20, 0);
+    std::vector<int> out;
+
+    std::iota(in.begin(), in.end(), 0);
+    auto twice = make_transform([](int i) { return i * 2; });
+    auto plus_one = make_transform([](int i) { return i + 1; });
+    auto even = make_filter([](int i) { return i % 2 == 0; });
+    auto under_ten = make_filter([](int i) { return i < 10; });
+
+    auto transforms = twice | plus_one;
+    static_assert(!details::is_composed_maker_v<decltype(transforms)>);
+    auto transformed = in | transforms;
+    static_assert(sizeof(transformed.begin()) == sizeof(in.begin()));
+    std::copy(transformed.begin(), transformed.end(), std::back_inserter(out));
+    ASSERT_EQ(out.size(), in.size());
+    ASSERT_EQ(out[0], 1);
+    ASSERT_EQ(out[19], 39);
+
+    auto filters = even | under_ten;
+    static_assert(!details::is_composed_maker_v<decltype(filters)>);
+    out.clear();
+    auto filtered = in | filters;
+    std::copy(filtered.begin(), filtered.end(), std::back_inserter(out));
+    ASSERT_EQ(out, (std::vector<int>{0, 2, 4, 6, 8}));
+
+    auto steps = make_step(2) | make_step(3);
+    static_assert(std::is_same_v<decltype(steps), details::step_maker>);
+    out.clear();
+    auto stepped = in | steps;
+    std::copy(stepped.begin(), stepped.end(), std::back_inserter(out));
+    ASSERT_EQ(out, (std::vector<int>{0, 6, 12, 18}));
+
+    auto deep = even | twice | make_step(2) | plus_one | make_step(2) | twice | under_ten | even;
+    using deep_tail = decltype(deep)::second_maker_type;
+    static_assert(std::is_same_v<deep_tail::first_maker_type, details::step_maker>);
+    static_assert(!details::is_composed_maker_v<deep_tail::second_maker_type::second_maker_type>);
+    out.clear();
+    auto deep_rng = in | deep;
+    std::copy(deep_rng.begin(), deep_rng.end(), std::back_inserter(out));
+    ASSERT_EQ(out, (std::vector<int>{2}));
+}
+
 TEST(smite, step)
 {
     std::vector<int> in(10, 0);
@@ -289,4 +403,1095 @@ TEST(smite, step)
     auto step_range2 = smite::step(in, 3);
     std::vector<int> expected2{0, 3, 6, 9};
     ASSERT_TRUE(std::equal(step_range2.begin(), step_range2.end(), expected2.begin()));
+
+    std::vector<int> big(2000, 0);
+    std::iota(big.begin(), big.end(), 0);
+    std::size_t tested = 0;
+    auto even = smite::filter(big, [&tested](int i) {
+        ++tested;
+        return i % 2 == 0;
+    });
+    int total = 0;
+    for (int i : smite::step(even, 2)) {
+        total += i;
+    }
+    ASSERT_EQ(total, 499000);
+    ASSERT_LE(tested, 2 * big.size());
+
+#ifndef NDEBUG
+    ASSERT_DEATH(smite::step(in, 0), "positive stride");
+    ASSERT_DEATH(smite::make_step(0), "positive stride");
+#endif
+}
+
+TEST(smite, step_random_access)
+{
+    std::vector<int> in(10, 0);
+    std::iota(in.begin(), in.end(), 0);
+
+    auto step_range = smite::step(in, 3);
+    auto b = step_range.begin();
+    auto e = step_range.end();
+    ASSERT_EQ(std::distance(b, e), 4);
+    ASSERT_EQ(e - b, 4);
+    ASSERT_EQ(b - e, -4);
+    ASSERT_EQ(*(b + 2), 6);
+    ASSERT_EQ(b[3], 9);
+    ASSERT_TRUE(b + 4 == e);
+    ASSERT_EQ(*(e - 1), 9);
+    ASSERT_EQ(*--e, 9);
+    ASSERT_EQ(*(e - 3), 0);
+    ASSERT_TRUE(std::binary_search(step_range.begin(), step_range.end(), 6));
+    ASSERT_FALSE(std::binary_search(step_range.begin(), step_range.end(), 7));
+
+    std::vector<int> shuffled{9, 4, 7, 1, 8, 3, 5, 2, 6, 0, 11};
+    auto stepped = smite::step(shuffled, 2);
+    auto mid = stepped.begin() + 3;
+    std::nth_element(stepped.begin(), mid, stepped.end());
+    ASSERT_EQ(*mid, 8);
+    ASSERT_TRUE(std::all_of(stepped.begin(), mid, [](int i) { return i < 8; }));
+    ASSERT_TRUE(std::all_of(mid, stepped.end(), [](int i) { return i >= 8; }));
+    auto untouched = smite::step(smite::make_range(shuffled.begin() + 1, shuffled.end()), 2);
+    ASSERT_TRUE(std::equal(untouched.begin(), untouched.end(), std::vector<int>{4, 1, 3, 2, 0}.begin()));
+
+    std::list<int> lst(in.begin(), in.end());
+    auto list_range = smite::step(lst, 3);
+    auto it = list_range.begin();
+    std::advance(it, 4);
+    ASSERT_TRUE(it == list_range.end());
+    ASSERT_EQ(*--it, 9);
+    ASSERT_EQ(std::distance(list_range.begin(), list_range.end()), 4);
+
+    using iter = typename decltype(step_range)::iterator;
+    static_assert(std::is_same_v<std::iterator_traits<iter>::iterator_category, std::random_access_iterator_tag>);
+}
+
+TEST(smite, static_step)
+{
+    using namespace smite;
+    std::vector<int> in(10, 0);
+    std::iota(in.begin(), in.end(), 0);
+
+    auto stepped = step<3>(in);
+    ASSERT_EQ(std::vector<int>(stepped.begin(), stepped.end()), (std::vector<int>{0, 3, 6, 9}));
+    ASSERT_EQ(stepped.size(), 4u);
+    auto e = stepped.end();
+    ASSERT_EQ(*--e, 9);
+    ASSERT_EQ(stepped.begin()[2], 6);
+    ASSERT_EQ(stepped.end()[-1], 9);
+    ASSERT_EQ(step(in, 4).end()[-3], 0);
+    ASSERT_EQ(sum(step<4>(in)), 12);
+    ASSERT_EQ(sum(step(in, 4)), 12);
+
+    using iter = decltype(stepped.begin());
+    using dynamic_iter = decltype(step(in, 3).begin());
+    static_assert(sizeof(iter) < sizeof(dynamic_iter));
+    static_assert(std::is_same_v<std::iterator_traits<iter>::iterator_category, std::random_access_iterator_tag>);
+
+    std::list<int> lst(in.begin(), in.end());
+    auto list_stepped = lst | make_step<4>();
+    ASSERT_EQ(std::vector<int>(list_stepped.begin(), list_stepped.end()), (std::vector<int>{0, 4, 8}));
+
+    static_assert(std::is_same_v<decltype(make_step<2>() | make_step<3>()), details::static_step_maker<6>>);
+    static_assert(std::is_same_v<decltype(make_step<2>() | make_step(3)), details::step_maker>);
+    ASSERT_EQ((make_step(2) | make_step<5>())._step, 10u);
+
+    std::vector<int> stereo{1, -1, 2, -2, 3, -3};
+    std::vector<int> left(3, 0);
+    std::vector<int> right(3, 0);
+    auto odd = make_range(stereo.begin() + 1, stereo.end());
+    for (auto &&[l, r, sample] : zip(left, right, zip(step<2>(stereo), step<2>(odd)))) {
+        l = std::get<0>(sample);
+        r = std::get<1>(sample);
+    }
+    ASSERT_EQ(left, (std::vector<int>{1, 2, 3}));
+    ASSERT_EQ(right, (std::vector<int>{-1, -2, -3}));
+}
+
+TEST(smite, take_drop)
+{
+    using namespace smite;
+    std::vector<int> in(10, 0);
+    std::iota(in.begin(), in.end(), 0);
+
+    auto first3 = take(in, 3);
+    static_assert(std::is_same_v<decltype(first3.begin()), std::vector<int>::iterator>);
+    ASSERT_EQ(first3 | to<std::vector<int>>(), (std::vector<int>{0, 1, 2}));
+    ASSERT_EQ(take(in, 42).size(), 10u);
+    ASSERT_EQ(take(in, 0).size(), 0u);
+    ASSERT_EQ(drop(in, 7) | to<std::vector<int>>(), (std::vector<int>{7, 8, 9}));
+    ASSERT_EQ(drop(in, 42).size(), 0u);
+    ASSERT_EQ(in | make_drop(2) | make_take(3) | to<std::vector<int>>(), (std::vector<int>{2, 3, 4}));
+    ASSERT_EQ(zip(in, in) | make_take(4) | make_transform([](auto p) { return std::get<0>(p) + std::get<1>(p); })
+                  | to<std::vector<int>>(), (std::vector<int>{0, 2, 4, 6}));
+    static_assert(std::is_same_v<decltype(make_take(5) | make_take(2)), details::take_maker>);
+    ASSERT_EQ(in | (make_take(5) | make_take(2)) | to<std::vector<int>>(), (std::vector<int>{0, 1}));
+    ASSERT_EQ(in | (make_drop(3) | make_drop(4)) | to<std::vector<int>>(), (std::vector<int>{7, 8, 9}));
+    ASSERT_EQ(count(in | make_drop(static_cast<std::size_t>(-1)) | make_drop(1)), 0);
+
+    std::list<int> lst(in.begin(), in.end());
+    ASSERT_EQ(lst | make_take(4) | to<std::vector<int>>(), (std::vector<int>{0, 1, 2, 3}));
+    ASSERT_EQ(lst | make_take(40) | to<std::vector<int>>(), in);
+    ASSERT_EQ(count(lst | make_take(0)), 0);
+    ASSERT_EQ(*(lst | make_drop(8)).begin(), 8);
+    ASSERT_EQ(count(null_terminated("smite!") | make_take(3)), 3);
+    ASSERT_EQ(count(null_terminated("smite!") | make_drop(4)), 2);
+
+    int tested = -1;
+    auto odd = make_filter([&tested](int i) {
+        tested = std::max(tested, i);
+        return i % 2 == 1;
+    });
+    std::vector<int> pulled;
+    for (int i : lst | odd | make_take(2)) {
+        pulled.push_back(i);
+    }
+    ASSERT_EQ(pulled, (std::vector<int>{1, 3}));
+    ASSERT_EQ(tested, 3);
+    tested = -1;
+    std::vector<int> pushed;
+    smite::for_each(lst | odd | make_take(3), [&pushed](int i) { pushed.push_back(i); });
+    ASSERT_EQ(pushed, (std::vector<int>{1, 3, 5}));
+    ASSERT_EQ(tested, 5);
+    ASSERT_FALSE(smite::for_each_until(lst | make_take(3), [](int i) { return i > 5; }));
+    ASSERT_TRUE(smite::for_each_until(lst | make_take(3), [](int i) { return i == 1; }));
+
+    std::istringstream stream("1 2 3 4");
+    auto numbers = make_range(std::istream_iterator<int>(stream), std::istream_iterator<int>());
+    ASSERT_EQ(take(numbers, 2) | to<std::vector<int>>(), (std::vector<int>{1, 2}));
+    int next = 0;
+    stream >> next;
+    ASSERT_EQ(next, 3);
+}
+
+TEST(smite, chunk)
+{
+    using namespace smite;
+    std::vector<int> in(10, 0);
+    std::iota(in.begin(), in.end(), 0);
+
+    auto chunks = chunk(in, 4);
+    ASSERT_EQ(chunks.size(), 3u);
+    std::vector<std::size_t> sizes;
+    for (auto c : chunks) {
+        static_assert(std::is_same_v<decltype(c), range<int *>>);
+        sizes.push_back(c.size());
+    }
+    ASSERT_EQ(sizes, (std::vector<std::size_t>{4, 4, 2}));
+    ASSERT_EQ((*chunks.begin()).begin(), in.data());
+    ASSERT_EQ(*chunks.begin()[2].begin(), 8);
+    auto last = chunks.end();
+    ASSERT_EQ((*--last).size(), 2u);
+    ASSERT_EQ(*(*(last - 1)).begin(), 4);
+    ASSERT_EQ(chunk(in, 5).size(), 2u);
+    ASSERT_EQ(chunk(std::vector<int>{}, 5).size(), 0u);
+
+    for (auto c : chunk(in, 3)) {
+        for (auto &i : c) {
+            i *= 2;
+        }
+    }
+    ASSERT_EQ(in[9], 18);
+
+    std::list<int> lst(in.begin(), in.end());
+    auto list_chunks = lst | make_chunk(3);
+    ASSERT_EQ(std::distance(list_chunks.begin(), list_chunks.end()), 4);
+    auto tail = *std::next(list_chunks.begin(), 3);
+    ASSERT_EQ(std::distance(tail.begin(), tail.end()), 1);
+    ASSERT_EQ(*tail.begin(), 18);
+
+    auto sums = zip(in, lst) | make_chunk(4) | make_transform([](auto c) {
+        int total = 0;
+        for (auto &&[a, b] : c) {
+            total += a + b;
+        }
+        return total;
+    });
+    ASSERT_EQ(std::vector<int>(sums.begin(), sums.end()), (std::vector<int>{24, 88, 68}));
+
+    for (auto [index, c] : enumerate(chunk(null_terminated("smite!"), 4))) {
+        ASSERT_EQ(std::distance(c.begin(), c.end()), index == 0 ? 4 : 2);
+    }
+
+    std::vector<int> big(2000, 0);
+    std::iota(big.begin(), big.end(), 0);
+    struct counting_even
+    {
+        bool operator()(int i) const
+        {
+            ++*tested;
+            return i % 2 == 0;
+        }
+
+        std::size_t *tested;
+    };
+    std::size_t tested = 0;
+    auto even = filter(big, counting_even{&tested});
+    std::size_t groups = 0;
+    for (auto c : chunk(even, 3)) {
+        ASSERT_EQ(*c.begin() % 6, 0);
+        ++groups;
+    }
+    ASSERT_EQ(groups, 334u);
+    ASSERT_LE(tested, 2 * big.size());
+}
+
+TEST(smite, sliding)
+{
+    using namespace smite;
+    std::vector<int> in(6, 0);
+    std::iota(in.begin(), in.end(), 1);
+
+    auto windows = sliding(in, 3);
+    ASSERT_EQ(windows.size(), 4u);
+    auto sums = windows | make_transform([](auto w) { return std::accumulate(w.begin(), w.end(), 0); });
+    ASSERT_EQ(sums | to<std::vector<int>>(), (std::vector<int>{6, 9, 12, 15}));
+    for (auto w : windows) {
+        static_assert(std::is_same_v<decltype(w), range<int *>>);
+        ASSERT_EQ(w.size(), 3u);
+    }
+    ASSERT_EQ((*windows.begin()[3].begin()), 4);
+    ASSERT_EQ(windows.begin()[1].begin(), in.data() + 1);
+    ASSERT_EQ(windows.begin().back(), 3);
+    auto last = windows.end();
+    ASSERT_EQ((*--last).begin(), in.data() + 3);
+    ASSERT_EQ(sliding(in, 6).size(), 1u);
+    ASSERT_EQ(sliding(in, 7).size(), 0u);
+    ASSERT_EQ(sliding(std::vector<int>{}, 1).size(), 0u);
+
+    std::list<int> lst(in.begin(), in.end());
+    auto list_windows = lst | make_sliding(2);
+    ASSERT_EQ(std::distance(list_windows.begin(), list_windows.end()), 5);
+    auto fronts = list_windows | make_transform([](auto w) { return *w.begin(); });
+    ASSERT_EQ(fronts | to<std::vector<int>>(), (std::vector<int>{1, 2, 3, 4, 5}));
+    ASSERT_EQ(count(sliding(std::list<int>{1, 2}, 3)), 0);
+    ASSERT_EQ(count(sliding(null_terminated("smite!"), 4)), 3);
+
+    std::istringstream stream("1 2 3 4 5 6");
+    std::vector<std::vector<int>> seen;
+    for (auto w : sliding(make_range(std::istream_iterator<int>(stream), std::istream_iterator<int>()), 4)) {
+        seen.emplace_back(w.begin(), w.end());
+    }
+    ASSERT_EQ(seen, (std::vector<std::vector<int>>{{1, 2, 3, 4}, {2, 3, 4, 5}, {3, 4, 5, 6}}));
+    std::istringstream short_stream("1 2");
+    ASSERT_EQ(count(sliding(make_range(std::istream_iterator<int>(short_stream), std::istream_iterator<int>()), 3)), 0);
+
+    struct counting_even
+    {
+        bool operator()(int i) const
+        {
+            ++*tested;
+            return i % 2 == 0;
+        }
+
+        std::size_t *tested;
+    };
+    std::vector<int> big(2000);
+    std::iota(big.begin(), big.end(), 0);
+    std::size_t tested = 0;
+    auto even = filter(big, counting_even{&tested});
+    std::size_t even_windows = 0;
+    auto even_range = sliding(even, 3);
+    for (auto it = even_range.begin(); it != even_range.end(); ++it) {
+        ++even_windows;
+    }
+    ASSERT_EQ(even_windows, 998u);
+    ASSERT_LE(tested, 2 * big.size());
+}
+
+TEST(smite, rolling)
+{
+    using namespace smite;
+    std::vector<int> in{5, 1, 4, 4, 2, 8, 7, 3, 6, 0};
+
+    auto naive = [&in](std::size_t size, auto fold) {
+        std::vector<decltype(fold(in.begin(), in.begin() + 1))> out;
+        for (std::size_t i = 0; i + size <= in.size(); ++i) {
+            out.push_back(fold(in.begin() + i, in.begin() + i + size));
+        }
+        return out;
+    };
+    auto min_of = [](auto first, auto last) { return *std::min_element(first, last); };
+    auto max_of = [](auto first, auto last) { return *std::max_element(first, last); };
+    auto sum_of = [](auto first, auto last) { return std::accumulate(first, last, 0LL); };
+
+    for (std::size_t size = 1; size <= in.size() + 1; ++size) {
+        ASSERT_EQ(rolling(in, size, rolling_sum{}) | to<std::vector<long long>>(), naive(size, sum_of));
+        ASSERT_EQ(rolling(in, size, rolling_min{}) | to<std::vector<int>>(), naive(size, min_of));
+        ASSERT_EQ(rolling(in, size, rolling_max{}) | to<std::vector<int>>(), naive(size, max_of));
+        ASSERT_EQ(rolling(in, size, [](int a, int b) { return std::max(a, b); }) | to<std::vector<int>>(),
+                  naive(size, max_of));
+    }
+    static_assert(std::is_same_v<std::decay_t<decltype(*rolling(in, 2, rolling_sum{}).begin())>, long long>);
+    ASSERT_EQ(rolling(in, 4, rolling_mean{}) | to<std::vector<double>>(),
+              (std::vector<double>{3.5, 2.75, 4.5, 5.25, 5.0, 6.0, 4.0}));
+    ASSERT_EQ(rolling(std::vector<int>{2, 2, 2, 1, 1}, 2, rolling_min{}) | to<std::vector<int>>(),
+              (std::vector<int>{2, 2, 1, 1}));
+
+    std::list<unsigned char> bytes{250, 250, 250, 1};
+    ASSERT_EQ(bytes | make_rolling(3, rolling_sum{}) | to<std::vector<unsigned long long>>(),
+              (std::vector<unsigned long long>{750, 501}));
+
+    std::istringstream stream("3 1 2 9 0 4");
+    auto stream_max = rolling(make_range(std::istream_iterator<int>(stream), std::istream_iterator<int>()), 3,
+                              rolling_max{});
+    ASSERT_EQ(stream_max | to<std::vector<int>>(), (std::vector<int>{3, 9, 9, 9}));
+}
+
+TEST(smite, split)
+{
+    using namespace smite;
+    using strings = std::vector<std::string_view>;
+
+    ASSERT_EQ(split("a,bc,,d", ',') | to<strings>(), (strings{"a", "bc", "", "d"}));
+    ASSERT_EQ(split(std::string("a,"), ',') | to<strings>(), (strings{"a", ""}));
+    ASSERT_EQ(split(std::string_view(), ',') | to<strings>(), (strings{""}));
+    ASSERT_EQ(lines("one\r\ntwo\n\nthree\n") | to<strings>(), (strings{"one", "two", "", "three"}));
+    ASSERT_EQ(lines("one\ntwo") | to<strings>(), (strings{"one", "two"}));
+    ASSERT_TRUE((lines("") | to<strings>()).empty());
+    ASSERT_EQ(lines("\n") | to<strings>(), (strings{""}));
+
+    std::string log = "INFO start\nERROR disk\nINFO tick\nERROR net\n";
+    auto errors = log | make_lines() | make_filter([](std::string_view l) { return l.rfind("ERROR", 0) == 0; })
+                  | make_transform([](std::string_view l) { return l.substr(6); });
+    ASSERT_EQ(errors | to<strings>(), (strings{"disk", "net"}));
+    ASSERT_EQ((*errors.begin()).data(), log.data() + 17);
+    auto numbered = enumerate(lines(log));
+    ASSERT_EQ(std::get<0>(*std::next(numbered.begin(), 3)), 3u);
+    ASSERT_EQ(std::get<1>(*std::next(numbered.begin(), 3)), "ERROR net");
+    ASSERT_EQ(count(lines(log)), 4);
+    ASSERT_EQ((*lines(log).begin()).size(), 10u);
+
+    std::vector<char> buffer(log.begin(), log.end());
+    auto fields = chunk(buffer, 22) | make_transform([](auto c) { return count(split(c, ' ')); });
+    ASSERT_EQ(fields | to<std::vector<std::ptrdiff_t>>(), (std::vector<std::ptrdiff_t>{3, 3}));
+    ASSERT_EQ(split(std::u16string(u"x|y"), u'|') | to<std::vector<std::u16string_view>>(),
+              (std::vector<std::u16string_view>{u"x", u"y"}));
+}
+
+TEST(smite, join)
+{
+    using namespace smite;
+    std::vector<std::vector<int>> pages{{}, {0, 1, 2}, {}, {}, {3}, {4, 5, 6, 7}, {}};
+    std::vector<int> all(8, 0);
+    std::iota(all.begin(), all.end(), 0);
+    auto odd = make_filter([](int i) { return i % 2 == 1; });
+
+    ASSERT_EQ(join(pages) | to<std::vector<int>>(), all);
+    ASSERT_EQ(count(join(std::vector<std::vector<int>>(3))), 0);
+    ASSERT_EQ(pages | make_join() | odd | to<std::vector<int>>(), (std::vector<int>{1, 3, 5, 7}));
+    ASSERT_EQ(sum(join(pages)), 28);
+    std::vector<int> pushed;
+    smite::for_each(join(pages) | odd, [&pushed](int i) { pushed.push_back(i); });
+    ASSERT_EQ(pushed, (std::vector<int>{1, 3, 5, 7}));
+    ASSERT_TRUE(smite::for_each_until(join(pages), [](int i) { return i == 4; }));
+
+    auto flat = join(pages);
+    auto middle = std::next(flat.begin(), 2);
+    auto stop = std::next(flat.begin(), 6);
+    std::vector<int> partial;
+    smite::for_each(make_range(middle, stop), [&partial](int i) { partial.push_back(i); });
+    ASSERT_EQ(partial, (std::vector<int>{2, 3, 4, 5}));
+    smite::for_each(make_range(std::next(middle), std::next(middle, 2)), [&partial](int i) { partial.push_back(i); });
+    ASSERT_EQ(partial.back(), 3);
+    for (auto &i : join(pages)) {
+        i *= 10;
+    }
+    ASSERT_EQ(pages[5][3], 70);
+
+    std::list<int> list(all.begin(), all.end());
+    ASSERT_EQ(join(chunk(list, 3)) | to<std::vector<int>>(), all);
+    auto numbered = enumerate(join(chunk(all, 3)) | odd);
+    ASSERT_EQ(std::get<0>(*std::next(numbered.begin(), 3)), 3);
+    ASSERT_EQ(join(split("a,bc,d", ',')) | to<std::string>(), "abcd");
+
+    std::map<int, std::vector<int>> buckets{{1, {4, 2}}, {3, {}}, {7, {1}}};
+    auto values = buckets | make_transform([](const auto &bucket) -> const std::vector<int> & {
+        return bucket.second;
+    });
+    ASSERT_EQ(join(values) | to<std::vector<int>>(), (std::vector<int>{4, 2, 1}));
+}
+
+TEST(smite, prefetch)
+{
+    using namespace smite;
+    std::vector<int> table(1000, 0);
+    std::vector<std::size_t> indices{5, 999, 0, 42, 7, 7, 300};
+    std::vector<std::size_t> prefetched;
+    std::iota(table.begin(), table.end(), 0);
+    auto row = [&](std::size_t i) {
+        prefetched.push_back(i);
+        return &table[i];
+    };
+    auto gather = make_transform([&table](std::size_t i) { return table[i]; });
+
+    auto ahead = prefetch<4>(indices, row);
+    ASSERT_EQ(prefetched, (std::vector<std::size_t>{5, 999, 0, 42}));
+    ASSERT_EQ(ahead | gather | to<std::vector<int>>(), (std::vector<int>{5, 999, 0, 42, 7, 7, 300}));
+    ASSERT_EQ(prefetched, (std::vector<std::size_t>{5, 999, 0, 42, 7, 7, 300}));
+    static_assert(sizeof(ahead.begin()) == 3 * sizeof(std::vector<std::size_t>::iterator) + sizeof(row));
+
+    prefetched.clear();
+    ASSERT_EQ(sum(prefetch(indices, row, 2) | gather), 1360);
+    ASSERT_EQ(prefetched, indices);
+    prefetched.clear();
+    ASSERT_EQ(count(prefetch(indices, row, 100)), 7);
+    ASSERT_EQ(prefetched, indices);
+
+    std::list<std::size_t> list(indices.begin(), indices.end());
+    prefetched.clear();
+    std::vector<int> pushed;
+    smite::for_each(list | make_prefetch<3>(row) | gather, [&pushed](int i) { pushed.push_back(i); });
+    ASSERT_EQ(pushed, (std::vector<int>{5, 999, 0, 42, 7, 7, 300}));
+    ASSERT_EQ(prefetched, indices);
+    auto runtime = list | make_prefetch(row, 5);
+    ASSERT_EQ(*std::next(runtime.begin(), 3), 42u);
+    ASSERT_EQ(runtime.begin().distance(), 5u);
+    ASSERT_EQ(null_terminated("abc") | make_prefetch<2>([](const char &c) { return &c; }) | to<std::string>(), "abc");
+}
+
+TEST(smite, interleave_chase)
+{
+    using namespace smite;
+    std::vector<std::list<int>> chains{{1, 2, 3}, {}, {10}, {20, 21}, {30, 31, 32, 33}};
+    using tagged = std::vector<std::pair<std::size_t, int>>;
+
+    ASSERT_EQ(interleave_chase<2>(chains) | to<tagged>(),
+              (tagged{{0, 1}, {2, 10}, {0, 2}, {3, 20}, {0, 3}, {3, 21}, {4, 30}, {4, 31}, {4, 32}, {4, 33}}));
+    auto values = make_transform([](auto &&p) { return p.second; });
+    ASSERT_EQ(interleave_chase<1>(chains) | values | to<std::vector<int>>(), join(chains) | to<std::vector<int>>());
+
+    std::vector<std::list<int>> regrouped(chains.size());
+    for (auto [index, value] : chains | make_interleave_chase<16>()) {
+        regrouped[index].push_back(value);
+    }
+    ASSERT_EQ(regrouped, chains);
+    ASSERT_EQ(count(interleave_chase(std::vector<std::list<int>>(5))), 0);
+    ASSERT_EQ(count(interleave_chase(chains) | make_filter([](auto &&p) { return p.second % 2 == 0; })), 5);
+
+    for (auto &&[index, value] : interleave_chase<3>(chains)) {
+        value += static_cast<int>(index) * 100;
+    }
+    ASSERT_EQ(chains[4].back(), 433);
+
+    std::unordered_set<int> set{1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    std::vector<std::size_t> bucket_indices(set.bucket_count());
+    std::iota(bucket_indices.begin(), bucket_indices.end(), 0);
+    auto chains_of = bucket_indices | make_transform([&set](std::size_t b) {
+        return make_range(set.cbegin(b), set.cend(b));
+    });
+    int total = 0;
+    std::size_t seen = 0;
+    for (auto [bucket, value] : interleave_chase<4>(chains_of)) {
+        ASSERT_EQ(set.bucket(value), bucket);
+        total += value;
+        ++seen;
+    }
+    ASSERT_EQ(total, 55);
+    ASSERT_EQ(seen, set.size());
+}
+
+TEST(smite, sentinel)
+{
+    const char str[] = "a1b2c3d4";
+    auto is_digit = [](char c) {
+        return c >= '0' && c <= '9';
+    };
+
+    std::string digits;
+    for (auto c : smite::filter(smite::null_terminated(str), is_digit)) {
+        digits += c;
+    }
+    ASSERT_EQ(digits, "1234");
+
+    std::string every_other;
+    for (auto c : smite::step(smite::null_terminated(str), 2)) {
+        every_other += c;
+    }
+    ASSERT_EQ(every_other, "abcd");
+
+    std::vector<std::ptrdiff_t> indices;
+    for (auto[idx, c] : smite::enumerate(smite::null_terminated(str))) {
+        if (is_digit(c)) {
+            indices.push_back(idx);
+        }
+    }
+    ASSERT_EQ(indices, (std::vector<std::ptrdiff_t>{1, 3, 5, 7}));
+
+    std::vector<int> values{5, 6, 7};
+    std::string pairs;
+    for (auto[c, v] : smite::zip(smite::null_terminated(str), values)) {
+        pairs += c;
+        pairs += std::to_string(v);
+    }
+    ASSERT_EQ(pairs, "a516b7");
+
+    auto upper = smite::transform(smite::filter(smite::null_terminated(str), is_digit), [](char c) {
+        return c - '0';
+    });
+    ASSERT_EQ(std::accumulate(upper.begin(), std::next(upper.begin(), 4), 0), 10);
+    int total = 0;
+    for (auto i : upper) {
+        total += i;
+    }
+    ASSERT_EQ(total, 10);
+
+    using null_iter = typename decltype(smite::filter(smite::null_terminated(str), is_digit))::iterator;
+    static_assert(sizeof(null_iter) == sizeof(const char *));
+
+    std::vector<int> vec(10, 0);
+    std::iota(vec.begin(), vec.end(), 0);
+    auto nested = smite::filter(smite::filter(smite::filter(vec, is_digit), is_digit), is_digit);
+    using nested_iter = typename decltype(nested)::iterator;
+    using inner_iter = typename decltype(smite::filter(vec, is_digit))::iterator;
+    static_assert(sizeof(nested_iter) == sizeof(inner_iter) + 2 * sizeof(std::vector<int>::iterator));
+    ASSERT_EQ(std::distance(nested.begin(), nested.end()), 0);
+}
+
+TEST(smite, zip_variadic)
+{
+    std::vector<int> ints{1, 2, 3, 4, 5};
+    std::vector<double> doubles{0.5, 1.5, 2.5};
+    std::vector<char> chars{'a', 'b', 'c', 'd'};
+
+    auto rng = smite::zip(ints, doubles, chars);
+    ASSERT_EQ(std::distance(rng.begin(), rng.end()), 3);
+    ASSERT_EQ(rng.end() - rng.begin(), 3);
+
+    std::string seen;
+    for (auto[i, d, c] : rng) {
+        seen += std::to_string(i) + c;
+        d *= 2;
+    }
+    ASSERT_EQ(seen, "1a2b3c");
+    ASSERT_EQ(doubles, (std::vector<double>{1, 3, 5}));
+    ASSERT_EQ(std::get<2>(rng.begin()[2]), 'c');
+
+    using iter = typename decltype(rng)::iterator;
+    static_assert(iter::is_indexed);
+    static_assert(sizeof(iter) == 3 * sizeof(std::vector<int>::iterator) + sizeof(std::ptrdiff_t));
+    static_assert(std::is_same_v<std::iterator_traits<iter>::iterator_category, std::random_access_iterator_tag>);
+
+    std::list<int> lst{10, 20};
+    std::size_t count = 0;
+    for (auto[i, l] : smite::zip(ints, lst)) {
+        ASSERT_EQ(l, i * 10);
+        ++count;
+    }
+    ASSERT_EQ(count, 2u);
+
+    std::size_t count2 = 0;
+    for (auto[l, i] : smite::zip(lst, ints)) {
+        ASSERT_EQ(l, i * 10);
+        ++count2;
+    }
+    ASSERT_EQ(count2, 2u);
+
+    const char str[] = "xyz";
+    std::string zipped;
+    for (auto[c, i, d] : smite::zip(smite::null_terminated(str), ints, doubles)) {
+        zipped += c;
+        zipped += std::to_string(i + static_cast<int>(d));
+    }
+    ASSERT_EQ(zipped, "x2y5z8");
+
+    auto odd = smite::filter(ints, [](int i) { return i % 2 == 1; });
+    auto filtered = smite::zip(odd, chars);
+    using filtered_iter = typename decltype(filtered)::iterator;
+    static_assert(!filtered_iter::is_indexed);
+    std::string picked;
+    for (auto[i, c] : filtered) {
+        picked += std::to_string(i) + c;
+    }
+    ASSERT_EQ(picked, "1a3b5c");
+    ASSERT_EQ(filtered.end() - filtered.begin(), 3);
+    ASSERT_EQ(filtered.begin() - filtered.end(), -3);
+    ASSERT_TRUE(filtered.begin() < filtered.end());
+
+    std::list<int> other{1, 2, 3};
+    auto lists = smite::zip(lst, other);
+    ASSERT_EQ(std::distance(lists.begin(), lists.end()), 2);
+    ASSERT_EQ(lists.end() - lists.begin(), 2);
+}
+
+TEST(smite, zip_sort)
+{
+    std::vector<int> keys{5, 3, 9, 1, 7, 3};
+    std::vector<std::string> values{"five", "three", "nine", "one", "seven", "three bis"};
+
+    auto rng = smite::zip(keys, values);
+    std::sort(rng.begin(), rng.end());
+    ASSERT_EQ(keys, (std::vector<int>{1, 3, 3, 5, 7, 9}));
+    ASSERT_EQ(values, (std::vector<std::string>{"one", "three", "three bis", "five", "seven", "nine"}));
+
+    std::sort(rng.begin(), rng.end(), [](const auto &lhs, const auto &rhs) {
+        return std::get<0>(lhs) > std::get<0>(rhs);
+    });
+    ASSERT_EQ(keys, (std::vector<int>{9, 7, 5, 3, 3, 1}));
+    ASSERT_EQ(values[0], "nine");
+    ASSERT_EQ(values[5], "one");
+
+    std::vector<int> stable_keys{2, 1, 2, 1, 0};
+    std::vector<char> payload{'a', 'b', 'c', 'd', 'e'};
+    auto stable = smite::zip(stable_keys, payload);
+    std::stable_sort(stable.begin(), stable.end(), [](const auto &lhs, const auto &rhs) {
+        return std::get<0>(lhs) < std::get<0>(rhs);
+    });
+    ASSERT_EQ(stable_keys, (std::vector<int>{0, 1, 1, 2, 2}));
+    ASSERT_EQ(payload, (std::vector<char>{'e', 'b', 'd', 'a', 'c'}));
+
+    auto mid = std::partition(stable.begin(), stable.end(), [](const auto &p) {
+        return std::get<1>(p) > 'b';
+    });
+    ASSERT_EQ(mid - stable.begin(), 3);
+    for (auto[k, c] : smite::make_range(stable.begin(), mid)) {
+        ASSERT_GT(c, 'b');
+        ASSERT_EQ(k, c == 'e' ? 0 : (c == 'd' ? 1 : 2));
+    }
+
+    std::tuple<int, std::string> moved = iter_move(rng.begin());
+    ASSERT_EQ(std::get<1>(moved), "nine");
+    ASSERT_TRUE(values[0].empty());
+
+    iter_swap(rng.begin() + 1, rng.begin() + 2);
+    ASSERT_EQ(keys[1], 5);
+    ASSERT_EQ(values[2], "seven");
+}
+
+TEST(smite, filter_batched)
+{
+    std::vector<int> vec(1000);
+    for (std::size_t i = 0; i < vec.size(); ++i) {
+        vec[i] = static_cast<int>((i * 7919) % 101);
+    }
+
+    for (int threshold : {0, 1, 50, 100, 101}) {
+        auto pred = [threshold](int i) {
+            return i < threshold;
+        };
+        auto rng = smite::filter(vec, pred);
+        static_assert(decltype(rng)::iterator::is_batched);
+
+        std::vector<int> expected;
+        std::copy_if(vec.begin(), vec.end(), std::back_inserter(expected), pred);
+        std::vector<int> got{rng.begin(), rng.end()};
+        ASSERT_EQ(got, expected);
+
+        std::vector<int> reversed;
+        auto it = rng.end();
+        while (it != rng.begin()) {
+            reversed.push_back(*--it);
+        }
+        ASSERT_TRUE(std::equal(reversed.rbegin(), reversed.rend(), expected.begin(), expected.end()));
+    }
+
+    std::size_t calls = 0;
+    auto counted = smite::filter(vec, [&calls](int i) {
+        ++calls;
+        return i % 3 == 0;
+    });
+    std::size_t kept = 0;
+    for (auto i : counted) {
+        ASSERT_EQ(i % 3, 0);
+        ++kept;
+    }
+    ASSERT_EQ(kept, static_cast<std::size_t>(std::count_if(vec.begin(), vec.end(), [](int i) { return i % 3 == 0; })));
+    ASSERT_EQ(calls, vec.size());
+
+    calls = 0;
+    auto transformed = smite::filter(smite::transform(vec, [](int i) { return i * 3; }), [&calls](int i) {
+        ++calls;
+        return i % 2 == 0;
+    });
+    static_assert(decltype(transformed)::iterator::is_batched);
+    std::vector<int> tripled;
+    for (auto i : vec) {
+        if (i * 3 % 2 == 0) {
+            tripled.push_back(i * 3);
+        }
+    }
+    std::vector<int> got;
+    for (auto i : transformed) {
+        got.push_back(i);
+    }
+    ASSERT_EQ(got, tripled);
+    ASSERT_EQ(calls, vec.size());
+
+    std::list<int> lst(vec.begin(), vec.end());
+    auto list_rng = smite::filter(lst, [](int) { return true; });
+    static_assert(!decltype(list_rng)::iterator::is_batched);
+}
+
+TEST(smite, push)
+{
+    using namespace smite;
+    std::vector<int> vec(100, 0);
+    std::list<int> list(100, 0);
+    std::iota(vec.begin(), vec.end(), 0);
+    std::iota(list.begin(), list.end(), 0);
+    auto odd = make_filter([](int i) { return i % 2 == 1; });
+    auto twice = make_transform([](int i) { return i * 2; });
+
+    auto pull = [](auto &&rng) {
+        std::vector<int> out;
+        for (auto &&i : rng) {
+            out.push_back(i);
+        }
+        return out;
+    };
+    auto push = [](auto &&rng) {
+        std::vector<int> out;
+        smite::for_each(rng, [&out](int i) { out.push_back(i); });
+        return out;
+    };
+    ASSERT_EQ(push(vec | make_step(3) | odd | twice), pull(vec | make_step(3) | odd | twice));
+    ASSERT_EQ(push(list | make_step(3) | odd | twice), pull(list | make_step(3) | odd | twice));
+    ASSERT_EQ(push(step(vec, 7)), pull(step(vec, 7)));
+    ASSERT_EQ(push(step(smite::make_range(vec.begin() + 1, vec.end()), 7)).front(), 1);
+    ASSERT_EQ(push(null_terminated("smite") | make_transform([](char c) { return c - 'a'; })),
+              (std::vector<int>{18, 12, 8, 19, 4}));
+
+    std::vector<std::ptrdiff_t> indices;
+    smite::for_each(enumerate(list | odd), [&indices](auto &&pair) {
+        ASSERT_EQ(pair.second, pair.first * 2 + 1);
+        indices.push_back(pair.first);
+    });
+    ASSERT_EQ(indices.size(), 50u);
+    ASSERT_EQ(indices.back(), 49);
+
+    std::size_t calls = 0;
+    auto decode = make_transform([&calls](int i) {
+        ++calls;
+        return std::to_string(i);
+    });
+    std::vector<std::string> names;
+    ASSERT_TRUE(smite::for_each_until(vec | decode | make_filter([](const std::string &s) { return s.size() == 2; }),
+                                      [&names](std::string s) {
+                                          names.push_back(std::move(s));
+                                          return names.size() == 3;
+                                      }));
+    ASSERT_EQ(names, (std::vector<std::string>{"10", "11", "12"}));
+    ASSERT_EQ(calls, 14u);
+    ASSERT_FALSE(smite::for_each_until(list, [](int i) { return i < 0; }));
+
+    ASSERT_EQ(smite::reduce(list | odd | twice, 0, std::plus<>{}), 5000);
+    ASSERT_EQ(count(null_terminated("smite")), 5);
+    ASSERT_EQ(count_if(list | twice, [](int i) { return i % 4 == 0; }), 50);
+    ASSERT_EQ(*min_max(list | make_step(10)), std::make_pair(0, 90));
+
+    auto [first, last] = details::unwrap_contiguous(vec.begin(), vec.end());
+    static_assert(std::is_same_v<decltype(first), int *>);
+    ASSERT_EQ(first, vec.data());
+    ASSERT_EQ(last - first, 100);
+    static_assert(std::is_same_v<decltype(details::unwrap_contiguous(list.begin(), list.end()).first),
+                                 std::list<int>::iterator>);
+    smite::for_each(step(step(vec, 2), 5), [](int &i) { i = -i; });
+    ASSERT_EQ(vec[10], -10);
+    ASSERT_EQ(vec[11], 11);
+    ASSERT_EQ(count_if(vec, [](int i) { return i < 0; }), 9);
+}
+
+TEST(smite, reduce)
+{
+    using namespace smite;
+    std::vector<int> ints(1000, 0);
+    std::vector<float> floats(1000, 0);
+    std::list<int> list(ints.size(), 0);
+
+    std::iota(ints.begin(), ints.end(), -500);
+    std::iota(floats.begin(), floats.end(), 0.f);
+    std::iota(list.begin(), list.end(), -500);
+    auto twice = make_transform([](int i) { return i * 2; });
+
+    ASSERT_EQ(sum(ints), -500);
+    ASSERT_EQ(sum(ints | twice), -1000);
+    ASSERT_EQ(sum(list | twice), -1000);
+    ASSERT_EQ(sum(ints | twice, std::int64_t{1}), -999);
+    ASSERT_EQ(sum(std::vector<int>{}), 0);
+    ASSERT_EQ(reduce(ints, 0, std::bit_xor<>{}), std::accumulate(ints.begin(), ints.end(), 0, std::bit_xor<>{}));
+    ASSERT_EQ(reduce(ints | make_step(100), std::string(), [](std::string s, int i) {
+        return s + std::to_string(i);
+    }), "-500-400-300-200-1000100200300400");
+
+    ASSERT_EQ(count(ints), 1000);
+    ASSERT_EQ(count(filter(list, [](int i) { return i > 0; })), 499);
+    ASSERT_EQ(count_if(ints | twice, [](int i) { return i % 4 == 0; }), 500);
+    ASSERT_EQ(count_if(list, [](int i) { return i < 0; }), 500);
+
+    auto bounds = min_max(ints | make_transform([](int i) { return i * i; }));
+    ASSERT_TRUE(bounds.has_value());
+    ASSERT_EQ(bounds->first, 0);
+    ASSERT_EQ(bounds->second, 250000);
+    auto list_bounds = min_max(list);
+    ASSERT_EQ(list_bounds->first, -500);
+    ASSERT_EQ(list_bounds->second, 499);
+    ASSERT_FALSE(min_max(std::vector<float>{}).has_value());
+
+    auto indices = enumerate(floats) | make_transform([](auto &&pair) {
+        return static_cast<float>(pair.first) - pair.second;
+    });
+    ASSERT_EQ(sum(indices), 0.f);
+    ASSERT_EQ(dot(floats, floats, 0.0), 332833500.0);
+    ASSERT_EQ(dot(ints, list, std::int64_t{0}), 83333500);
+    ASSERT_EQ(reduce(zip(ints, floats), 0.0, [](double acc, auto &&z) {
+        return acc + std::get<0>(z) * std::get<1>(z);
+    }), 332833500.0 - 500.0 * 499500.0);
+
+    static_assert(details::is_indexable_v<decltype(zip(ints, floats).begin()), decltype(zip(ints, floats).end())>);
+    static_assert(details::is_indexable_v<decltype(indices.begin()), decltype(indices.end())>);
+    static_assert(!details::is_indexable_v<decltype((list | twice).begin()), decltype((list | twice).end())>);
+}
+
+TEST(smite, collect)
+{
+    using namespace smite;
+    std::vector<int> ints(100, 0);
+    std::list<int> list(ints.size(), 0);
+    std::vector<float> floats(ints.size(), 0);
+
+    std::iota(ints.begin(), ints.end(), 0);
+    std::iota(list.begin(), list.end(), 0);
+    std::iota(floats.begin(), floats.end(), 0.f);
+    auto twice = make_transform([](int i) { return i * 2; });
+    auto even = make_filter([](int i) { return i % 2 == 0; });
+
+    ASSERT_EQ(make_range(ints.begin(), ints.end()).size(), 100u);
+    ASSERT_EQ((ints | twice).size(), 100u);
+    ASSERT_EQ(zip(ints, floats, ints | twice).size(), 100u);
+    ASSERT_EQ(step(ints, 3).size(), 34u);
+    ASSERT_EQ((ints | enumerate | make_step(10)).size(), 10u);
+    static_assert(!details::is_sized_v<decltype((ints | even).begin()), decltype((ints | even).end())>);
+    static_assert(!details::is_sized_v<decltype((list | twice).begin()), decltype((list | twice).end())>);
+    static_assert(!details::is_sized_v<decltype(null_terminated("").begin()), decltype(null_terminated("").end())>);
+
+    auto doubled = ints | twice | to<std::vector<int>>();
+    ASSERT_EQ(doubled.size(), 100u);
+    ASSERT_EQ(doubled.capacity(), 100u);
+    ASSERT_EQ(doubled[99], 198);
+
+    auto evens = ints | even | twice | to<std::vector<long>>();
+    ASSERT_EQ(evens.size(), 50u);
+    ASSERT_EQ(evens.capacity(), 100u);
+    ASSERT_EQ(evens[1], 4);
+    ASSERT_EQ(*details::size_upper_bound((ints | even | twice).begin(), (ints | even | twice).end()), 100u);
+
+    auto rows = zip(ints, floats) | to<std::vector<std::tuple<int, float>>>();
+    ASSERT_EQ(rows.capacity(), 100u);
+    ASSERT_EQ(rows[42], std::make_tuple(42, 42.f));
+
+    auto from_list = list | twice | to<std::list<int>>();
+    ASSERT_EQ(from_list.back(), 198);
+    auto chars = null_terminated("smite") | to<std::string>();
+    ASSERT_EQ(chars, "smite");
+}
+
+TEST(smite, parallel)
+{
+    using namespace smite;
+    par::thread_pool pool(4);
+    par::options opts;
+    opts.pool = &pool;
+    opts.grain = 1000;
+    std::vector<int> ints(100000, 0);
+    std::vector<double> doubles(ints.size(), 0);
+    std::vector<std::ptrdiff_t> seen(ints.size(), -1);
+
+    std::iota(ints.begin(), ints.end(), 0);
+    std::iota(doubles.begin(), doubles.end(), 0.1);
+    par::for_each(enumerate(ints), [&seen](auto &&pair) {
+        seen[pair.second] = pair.first;
+    }, opts);
+    ASSERT_TRUE(std::equal(seen.begin(), seen.end(), ints.begin()));
+
+    par::for_each(zip(ints, doubles) | make_step(2), [](auto &&z) {
+        std::get<1>(z) = std::get<0>(z);
+    }, opts);
+    ASSERT_EQ(doubles[0], 0.0);
+    ASSERT_EQ(doubles[1], 1.1);
+    ASSERT_EQ(doubles[99998], 99998.0);
+
+    auto twice = make_transform([](int i) { return std::int64_t{i} * 2; });
+    ASSERT_EQ(par::reduce(ints | twice, std::int64_t{1}, std::plus<>{}, opts), 9999900001);
+    ASSERT_EQ(par::reduce(std::vector<int>{}, 3, std::plus<>{}, opts), 3);
+    std::list<int> list(ints.begin(), ints.end());
+    ASSERT_EQ(par::reduce(list, std::int64_t{0}, std::plus<>{}, opts), 4999950000);
+
+    par::options deterministic;
+    deterministic.pool = &pool;
+    deterministic.deterministic = true;
+    auto first = par::reduce(doubles, 0.0, std::plus<>{}, deterministic);
+    for (int i = 0; i < 10; ++i) {
+        par::thread_pool other_pool(1 + i % 3);
+        deterministic.pool = &other_pool;
+        ASSERT_EQ(par::reduce(doubles, 0.0, std::plus<>{}, deterministic), first);
+    }
+
+    std::atomic<int> nested{0};
+    par::for_each(step(ints, 10000), [&](int) {
+        par::for_each(step(ints, 1000), [&](int) { ++nested; }, opts);
+    }, opts);
+    ASSERT_EQ(nested, 1000);
+
+    ASSERT_THROW(par::for_each(ints, [](int i) {
+        if (i == 4242) {
+            throw std::runtime_error("boom");
+        }
+    }, opts), std::runtime_error);
+}
+
+TEST(smite, parallel_compaction)
+{
+    using namespace smite;
+    par::thread_pool pool(4);
+    par::options opts;
+    opts.pool = &pool;
+    opts.grain = 1000;
+    std::vector<int> ints(100000, 0);
+    auto multiple_of_3 = make_filter([](int i) { return i % 3 == 0; });
+
+    std::iota(ints.begin(), ints.end(), 0);
+    auto selected = par::collect<std::vector<int>>(ints | multiple_of_3, opts);
+    ASSERT_EQ(selected, ints | multiple_of_3 | to<std::vector<int>>());
+    ASSERT_EQ(selected.size(), 33334u);
+    ASSERT_EQ(selected.back(), 99999);
+
+    auto names = make_transform([](int i) { return std::to_string(i); });
+    auto long_names = ints | names | make_filter([](const std::string &s) { return s.size() == 5; })
+                      | par::to<std::vector<std::string>>(opts);
+    ASSERT_EQ(long_names.size(), 90000u);
+    ASSERT_EQ(long_names.front(), "10000");
+    ASSERT_EQ(long_names.back(), "99999");
+
+    ASSERT_TRUE((ints | make_filter([](int i) { return i < 0; }) | par::to<std::vector<int>>(opts)).empty());
+    ASSERT_TRUE(par::collect<std::vector<int>>(std::vector<int>{} | multiple_of_3, opts).empty());
+    std::list<int> list(ints.begin(), ints.end());
+    ASSERT_EQ(par::collect<std::vector<int>>(list | multiple_of_3, opts), selected);
+    ASSERT_EQ((ints | multiple_of_3 | par::to<std::list<int>>(opts)).size(), 33334u);
+}
+
+TEST(smite, mmap_records)
+{
+    using namespace smite;
+    struct record
+    {
+        std::int32_t id;
+        float value;
+    };
+    std::vector<record> written(10000);
+    auto path = testing::TempDir() + "smite-mmap-records.bin";
+
+    for (std::size_t i = 0; i < written.size(); ++i) {
+        written[i] = record{static_cast<std::int32_t>(i), static_cast<float>(i) / 2};
+    }
+    auto file = std::fopen(path.c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    std::fwrite(written.data(), sizeof(record), written.size(), file);
+    std::fputc(42, file);
+    std::fclose(file);
+
+    mmap_options opts;
+    opts.access = access_pattern::sequential;
+    opts.huge_pages = true;
+    auto records = mmap_records<record>(path, opts);
+    ASSERT_EQ(records.size(), written.size());
+    ASSERT_EQ(records[4242].id, 4242);
+    static_assert(std::is_same_v<decltype(records.begin()), const record *>);
+
+    auto ids = records | make_transform([](const record &r) { return std::int64_t{r.id}; });
+    ASSERT_EQ(sum(ids, std::int64_t{0}), 49995000);
+    auto even = records | make_filter([](const record &r) { return r.id % 2 == 0; });
+    ASSERT_EQ(count(even), 5000);
+    ASSERT_EQ((*(step(records, 1000).begin() + 3)).id, 3000);
+    ASSERT_EQ(par::reduce(ids, std::int64_t{0}, std::plus<>{}), 49995000);
+
+    auto moved = std::move(records);
+    ASSERT_EQ(moved.size(), written.size());
+    ASSERT_TRUE(records.empty());
+
+    opts.access = access_pattern::random;
+    opts.populate = true;
+    auto bytes = mmap_records<char>(path, opts);
+    ASSERT_EQ(bytes.size(), written.size() * sizeof(record) + 1);
+    ASSERT_EQ(bytes[bytes.size() - 1], 42);
+
+    std::fclose(std::fopen(path.c_str(), "wb"));
+    ASSERT_TRUE(mmap_records<record>(path).empty());
+    std::remove(path.c_str());
+    ASSERT_THROW(mmap_records<record>(path), std::system_error);
+}
+
+TEST(smite, read_blocks)
+{
+    using namespace smite;
+    std::string text;
+    int fds[2];
+
+    for (int i = 0; i < 5000; ++i) {
+        text += "line " + std::to_string(i) + "\n";
+    }
+    ASSERT_EQ(::pipe(fds), 0);
+    std::thread writer([&] {
+        for (std::size_t written = 0; written < text.size(); written += 777) {
+            auto size = std::min<std::size_t>(777, text.size() - written);
+            ASSERT_EQ(::write(fds[1], text.data() + written, size), static_cast<ssize_t>(size));
+        }
+        ::close(fds[1]);
+    });
+    std::string read;
+    std::vector<std::size_t> sizes;
+    for (auto block : read_blocks(fds[0], 4096)) {
+        static_assert(std::is_same_v<decltype(block), range<const char *>>);
+        read.append(block.begin(), block.end());
+        sizes.push_back(block.size());
+    }
+    writer.join();
+    ::close(fds[0]);
+    ASSERT_EQ(read, text);
+    ASSERT_EQ(sizes.size(), (text.size() + 4095) / 4096);
+    ASSERT_TRUE(std::all_of(sizes.begin(), sizes.end() - 1, [](std::size_t s) { return s == 4096; }));
+
+    auto path = testing::TempDir() + "smite-read-blocks.txt";
+    auto file = std::fopen(path.c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    std::fwrite(text.data(), 1, text.size(), file);
+    std::fclose(file);
+    auto fd = ::open(path.c_str(), O_RDONLY);
+    ASSERT_GE(fd, 0);
+    block_options opts;
+    opts.buffers = 2;
+    opts.drop_cache = true;
+    auto file_blocks = read_blocks(fd, 1000, opts);
+    auto newlines = file_blocks | make_transform([](auto block) {
+        return count(split(block, '\n')) - 1;
+    });
+    ASSERT_EQ(sum(newlines, std::ptrdiff_t{0}), 5000);
+    ::close(fd);
+
+    fd = ::open(path.c_str(), O_RDONLY);
+    ASSERT_GE(fd, 0);
+    {
+        auto blocks = read_blocks(fd, 16);
+        auto first = *blocks.begin();
+        ASSERT_EQ(std::string(first.begin(), first.end()), "line 0\nline 1\nli");
+    }
+    ::close(fd);
+
+    fd = ::open(path.c_str(), O_RDONLY);
+    ASSERT_GE(fd, 0);
+    for (bool ring : {true, false}) {
+        block_options from_offset;
+        from_offset.buffers = 3;
+        from_offset.io_uring = ring;
+        ASSERT_EQ(::lseek(fd, 5, SEEK_SET), 5);
+        std::string tail;
+        for (auto block : read_blocks(fd, 333, from_offset)) {
+            ASSERT_TRUE(block.size() == 333 || tail.size() + block.size() == text.size() - 5);
+            tail.append(block.begin(), block.end());
+        }
+        ASSERT_EQ(tail, text.substr(5));
+        ASSERT_EQ(::lseek(fd, 0, SEEK_CUR), 5);
+    }
+    ::close(fd);
+    std::remove(path.c_str());
+    ASSERT_THROW(read_blocks(-1, 16).begin(), std::system_error);
 }